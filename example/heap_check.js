@@ -0,0 +1,35 @@
+// Checks that a steady-state I2C sampling loop doesn't allocate on the
+// JerryScript heap. Needs a build with JMEM_STATS defined (see
+// workspace/jerryscript/README.md).
+
+var i2c = I2C(I2C_SDA, I2C_SCL);
+var sample = Uint8Array(6);
+var stats = heap_stats();
+
+var ACCEL_ADDRESS = 0x3A;
+var ACCEL_OUT_X_MSB = Uint8Array([0x01]);
+
+function read_sample()
+{
+  i2c.write(ACCEL_ADDRESS, ACCEL_OUT_X_MSB, true);
+  i2c.read(ACCEL_ADDRESS, sample);
+}
+
+// Warm up, so that anything allocated once (e.g. property names) is already
+// on the heap.
+for (var i = 0; i < 10; i++)
+{
+  read_sample();
+}
+
+heap_stats(stats);
+var allocated_before = stats.alloc_count;
+
+for (var i = 0; i < 100; i++)
+{
+  read_sample();
+}
+
+heap_stats(stats);
+print("Sampling loop made " + (stats.alloc_count - allocated_before) + " heap allocations.");
+assert(stats.alloc_count === allocated_before);
@@ -71,12 +71,23 @@ HEADER = '''#include "jsmbed_js_source.h"
 
 OUT_PATH = './source/'
 SRC_PATH = './js/'
+WRAPPER_PATHS = ['./jerryscript/source/', './source/']
+MAGIC_STRINGS_INC = './jerryscript/jerryscript-lib/include/jerry-core/lit/lit-magic-strings.inc.h'
 
 parser = argparse.ArgumentParser()
 parser.add_argument("-b", "--buildtype")
 parser.add_argument("-m", "--mcu")
+parser.add_argument("-w", "--wrapper-path", action="append",
+                    help="directory to scan for wrapper registrations (default: {})".format(", ".join(WRAPPER_PATHS)))
+parser.add_argument("--magic-threshold", type=int, default=2,
+                    help="minimum number of uses before a literal in the JS sources becomes a magic string")
+parser.add_argument("--max-magic-strings", type=int, default=256,
+                    help="maximum number of magic strings taken from the JS sources")
 args = parser.parse_args();
 
+if args.wrapper_path:
+    WRAPPER_PATHS = args.wrapper_path
+
 buildtype = 'release'
 if args.buildtype:
     buildtype = args.buildtype
@@ -124,6 +135,7 @@ fout.write(HEADER);
 
 pins = list()
 pin_def_re = re.compile("var ([a-zA-Z_0-9]+)\s*=\s*([^;]*);")
+sources = list()
 
 def exportOneFile(path, name):
     # Prepend pins.js onto main.js, don't include pins.js itself.
@@ -149,6 +161,8 @@ def exportOneFile(path, name):
         code = removeComments(code)
         code = removeWhitespaces(code)
 
+    sources.append(code)
+
     for line in regroup(code, 10):
         buf = ', '.join(map(lambda ch: format(ord(ch),"#04x"), line))
         if line[-1] != '\0':
@@ -184,34 +198,91 @@ for name in filenames:
 writeLine(fout, '{ 0, 0, 0 }', 1)
 writeLine(fout, '};')
 
-pin_count = len(pins)
-writeLine(fout, 'unsigned int jsmbed_js_magic_string_count = {};'.format(pin_count))
-
-writeLine(fout, 'const char *jsmbed_js_magic_strings[] = {')
-comma = ","
-
-for (idx, (pinname, value)) in enumerate(pins):
-    if idx == (pin_count-1):
-        comma = ""
-    writeLine(fout, '  "{}"{}'.format(pinname, comma), 1)
-writeLine(fout, '};')
-
-writeLine(fout, 'unsigned int jsmbed_js_magic_string_lengths[] = {')
-comma = ","
-
-for (idx, (pinname, value)) in enumerate(pins):
-    if idx == (pin_count-1):
-        comma = ""
-    writeLine(fout, '  {}{}'.format(len(pinname), comma), 1)
-writeLine(fout, '};')
+# Names registered by the wrappers (functions, classes, methods, keys and
+# schema fields). These end up as property names in every program, so they always become
+# magic strings.
+binding_name_res = [
+    re.compile(r'REGISTER_GLOBAL_FUNCTION\s*\(\s*(\w+)\s*\)'),
+    re.compile(r'REGISTER_CLASS_CONSTRUCTOR\s*\(\s*(\w+)\s*\)'),
+    re.compile(r'ATTACH_CLASS_FUNCTION\s*\([^,]+,\s*\w+\s*,\s*(\w+)\s*\)'),
+    re.compile(r'DECLARE_JS_KEY\s*\(\s*(\w+)\s*\)'),
+    re.compile(r'JS_SCHEMA_FIELD\s*\(\s*\w+\s*,\s*(\w+)'),
+]
+
+def findBindingNames(paths):
+    names = set()
+    for path in paths:
+        for root, dirs, filenames in os.walk(path):
+            for filename in filenames:
+                if not filename.endswith(('.cpp', '.h')):
+                    continue
+                with open(os.path.join(root, filename), 'r') as fin:
+                    for line in fin.readlines():
+                        # Skip the macro definitions themselves, and usage
+                        # examples in comments.
+                        if line.strip().startswith(('#', '*', '//')):
+                            continue
+                        for name_re in binding_name_res:
+                            names.update(name_re.findall(line))
+    return names
+
+# String literals and property names used in the JS sources. Each distinct
+# one would otherwise be allocated on the JS heap.
+js_string_re = re.compile(r'"((?:[^"\\\n]|\\.)*)"|\'((?:[^\'\\\n]|\\.)*)\'')
+js_property_re = re.compile(r'\.\s*([A-Za-z_$][\w$]*)')
+
+def findFrequentLiterals(codes, threshold, limit):
+    counts = dict()
+    for code in codes:
+        for match in js_string_re.finditer(code):
+            literal = match.group(1) if match.group(1) is not None else match.group(2)
+            # Escapes would need decoding, and the lengths registered with the
+            # engine are byte lengths, so leave anything but plain ASCII alone.
+            if literal and '\\' not in literal and all(ord(ch) < 128 for ch in literal):
+                counts[literal] = counts.get(literal, 0) + 1
+        for name in js_property_re.findall(code):
+            counts[name] = counts.get(name, 0) + 1
+    frequent = [ literal for (literal, count) in counts.items() if count >= threshold ]
+    frequent.sort(key=lambda literal: (-counts[literal], literal))
+    return set(frequent[:limit])
+
+# The engine's own magic strings, which don't need registering again.
+def findEngineMagicStrings(path):
+    names = set()
+    if os.path.exists(path):
+        with open(path, 'r') as fin:
+            names.update(re.findall(r'LIT_MAGIC_STRING_DEF\s*\(\s*\w+\s*,\s*"([^"]*)"\s*\)', fin.read()))
+    return names
+
+def cString(string):
+    return '"' + string.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+pin_names = set(pinname for (pinname, value) in pins)
+magic_strings = (findBindingNames(WRAPPER_PATHS)
+                 | findFrequentLiterals(sources, args.magic_threshold, args.max_magic_strings))
+magic_strings -= findEngineMagicStrings(MAGIC_STRINGS_INC)
+magic_strings |= pin_names
+magic_strings = sorted(magic_strings, key=lambda string: (len(string), string))
+magic_string_ids = dict((string, idx) for (idx, string) in enumerate(magic_strings))
+
+def writeTable(ctype, name, entries):
+    # Zero-length arrays aren't valid C++, so empty tables get a dummy entry.
+    if len(entries) == 0:
+        entries = [ '0' ]
+    writeLine(fout, 'const {} {}[] = {{'.format(ctype, name))
+    for (idx, entry) in enumerate(entries):
+        comma = "," if idx != (len(entries)-1) else ""
+        writeLine(fout, '  {}{}'.format(entry, comma), 1)
+    writeLine(fout, '};')
 
-writeLine(fout, 'unsigned int jsmbed_js_magic_string_values[] = {')
-comma = ","
+writeLine(fout, '')
+writeLine(fout, 'const unsigned int jsmbed_js_magic_string_count = {};'.format(len(magic_strings)))
+writeTable('char * const', 'jsmbed_js_magic_strings', [ cString(string) for string in magic_strings ])
+writeTable('unsigned int', 'jsmbed_js_magic_string_lengths', [ str(len(string)) for string in magic_strings ])
 
-for (idx, (pinname, value)) in enumerate(pins):
-    if idx == (pin_count-1):
-        comma = ""
-    writeLine(fout, '  {}{}'.format(value, comma), 1)
-writeLine(fout, '};')
+writeLine(fout, '')
+writeLine(fout, 'const unsigned int jsmbed_js_pin_count = {};'.format(len(pins)))
+writeTable('unsigned int', 'jsmbed_js_pin_magic_string_ids', [ str(magic_string_ids[pinname]) for (pinname, value) in pins ])
+writeTable('unsigned int', 'jsmbed_js_pin_values', [ value for (pinname, value) in pins ])
 
-fout.close()
\ No newline at end of file
+fout.close()
@@ -20,13 +20,11 @@
 
 // For jsmbed_wrap_register_all_functions
 #include "jsmbed_wrap_registry.h"
+// For jsmbed_wrap_intern_core_keys
+#include "jsmbed_wrap_keys.h"
 
 #include "jsmbed_js_jerrycall.h"
-
-extern unsigned int jsmbed_js_magic_string_count;
-extern const char *jsmbed_js_magic_strings[];
-extern unsigned int jsmbed_js_magic_string_lengths[];
-extern unsigned int jsmbed_js_magic_string_values[];
+#include "jsmbed_js_source.h"
 
 static void jsmbed_js_load_magic_strings()
 {
@@ -44,10 +42,14 @@ static void jsmbed_js_load_magic_strings()
   jerry_value_t constant_value;
   constant_value.type = JERRY_DATA_TYPE_UINT32;
 
-  for (int idx = 0; idx < jsmbed_js_magic_string_count; idx++)
+  for (unsigned int idx = 0; idx < jsmbed_js_pin_count; idx++)
   {
-    constant_value.u.v_uint32 = jsmbed_js_magic_string_values[idx];
-    jerry_set_object_field_value(global, (const jerry_char_t*) jsmbed_js_magic_strings[idx], &constant_value);
+    unsigned int string_id = jsmbed_js_pin_magic_string_ids[idx];
+    constant_value.u.v_uint32 = jsmbed_js_pin_values[idx];
+    jerry_set_object_field_value_sz(global,
+        (const jerry_char_t*) jsmbed_js_magic_strings[string_id],
+        jsmbed_js_magic_string_lengths[string_id],
+        &constant_value);
   }
 
   jerry_release_object(global);
@@ -64,6 +66,7 @@ int jsmbed_js_entry (const char *source_p, const size_t source_size)
   jerry_init (flags);
 
   jsmbed_js_load_magic_strings ();
+  jsmbed_wrap_intern_core_keys ();
   jsmbed_wrap_register_all_functions ();
 
   if (!jerry_parse (jerry_src, source_size, &err_obj_p))
@@ -145,5 +148,6 @@ int jsmbed_js_exec_function (jerry_value_t *func_to_exec, jerry_value_t *args, i
 
 void jsmbed_js_exit (void)
 {
+  jsmbed_wrap_release_keys ();
   jerry_cleanup ();
 }
@@ -66,10 +66,21 @@ void jsmbed_js_launch (void)
   LOG_PRINT_ALWAYS ("   hash   %s\r\n", jerry_commit_hash);
   LOG_PRINT_ALWAYS ("   branch %s\r\n", jerry_branch_name);
 
+  jsmbed_wrap_set_event_loop_thread();
+
   if (load_javascript() == 0)
   {
+    uint32_t reported_drops = 0;
+
     while (true)
     {
+      uint32_t drops = jsmbed_wrap_get_dropped_message_count();
+      if (drops != reported_drops)
+      {
+        LOG_PRINT_ALWAYS("[EVENT LOOP] WARNING: MAILBOX FULL, %u MESSAGES DROPPED\n", (unsigned int) drops);
+        reported_drops = drops;
+      }
+
       osEvent evt = jsmbed_js_callback_mailbox.get(0);
       if (evt.status == osEventMail)
       {
@@ -116,6 +127,12 @@ void jsmbed_js_launch (void)
           jerry_release_object(function);
           LOG_PRINT("[EVENT LOOP] RELEASE-COMPLETE 0x%p\n", function);
         }
+        else if (msg->action == CALL_NATIVE)
+        {
+          LOG_PRINT("[EVENT LOOP] CALL-NATIVE 0x%p (0x%p)\n", msg->native_function, msg->native_context);
+          msg->native_function(msg->native_context);
+          LOG_PRINT("[EVENT LOOP] CALL-NATIVE-COMPLETE 0x%p\n", msg->native_function);
+        }
         else if (msg->action == ERROR_CORRUPT_JS_CALLBACK)
         {
           LOG_PRINT_ALWAYS("[EVENT LOOP] ERROR: JS_CALLBACK WAS CORRUPT: 0x%p\n", function);
@@ -24,5 +24,25 @@ struct jsmbed_js_source_t {
   const int length;
 };
 
+/*
+ * External magic strings, generated by js2c.py. These are registered with
+ * the engine so that names which appear in them (binding names, pin names,
+ * and frequently used literals from the JavaScript sources) are stored in
+ * flash instead of on the JS heap.
+ *
+ * The strings are sorted by length, then by content.
+ */
+extern const unsigned int jsmbed_js_magic_string_count;
+extern const char * const jsmbed_js_magic_strings[];
+extern const unsigned int jsmbed_js_magic_string_lengths[];
+
+/*
+ * Pin names are also defined as global constants. These give the index of
+ * each pin name in jsmbed_js_magic_strings, and the value of the pin.
+ */
+extern const unsigned int jsmbed_js_pin_count;
+extern const unsigned int jsmbed_js_pin_magic_string_ids[];
+extern const unsigned int jsmbed_js_pin_values[];
+
 #endif
 
@@ -0,0 +1,66 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include "jerry-core/jerry.h"
+
+#include "jsmbed_wrap_log_macros.h"
+
+#include "jsmbed_wrap_external_memory.h"
+
+static jsmbed_wrap_external_memory_stats_t external_memory = {
+  0, 0, 0, JSMBED_EXTERNAL_MEMORY_GC_THRESHOLD, 0
+};
+
+void jsmbed_wrap_external_memory_add(size_t bytes)
+{
+  external_memory.bytes += bytes;
+  if (external_memory.bytes > external_memory.peak_bytes)
+  {
+    external_memory.peak_bytes = external_memory.bytes;
+  }
+
+  external_memory.bytes_since_gc += bytes;
+  if (external_memory.threshold != 0 && external_memory.bytes_since_gc >= external_memory.threshold)
+  {
+    LOG_PRINT("[EXTERNAL MEMORY] GC at %lu bytes (%lu since last GC)\n",
+        (unsigned long) external_memory.bytes, (unsigned long) external_memory.bytes_since_gc);
+    external_memory.bytes_since_gc = 0;
+    external_memory.gc_count++;
+    jerry_gc();
+  }
+}
+
+void jsmbed_wrap_external_memory_remove(size_t bytes)
+{
+  if (bytes > external_memory.bytes)
+  {
+    LOG_PRINT_ALWAYS("ERROR: releasing %lu bytes of external memory, but only %lu are held.\n",
+        (unsigned long) bytes, (unsigned long) external_memory.bytes);
+    bytes = external_memory.bytes;
+  }
+  external_memory.bytes -= bytes;
+}
+
+void jsmbed_wrap_external_memory_set_threshold(uint32_t threshold)
+{
+  external_memory.threshold = threshold;
+}
+
+void jsmbed_wrap_external_memory_get_stats(jsmbed_wrap_external_memory_stats_t *stats)
+{
+  *stats = external_memory;
+}
@@ -0,0 +1,62 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JSMBED_WRAP_EXTERNAL_MEMORY_H__
+#define __JSMBED_WRAP_EXTERNAL_MEMORY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Accounting for native memory held by JS objects.
+ *
+ * The engine's GC only sees the small JS object that a native handle is
+ * linked to, not the native object (or buffers) behind it, so it has no
+ * reason to run while native memory is filling up. Native constructors and
+ * destructors report what they hold here, and once the memory reported since
+ * the last collection crosses a threshold, the GC is run so that unreachable
+ * wrappers release their native objects.
+ */
+
+/*
+ * Bytes of external memory that can be added before a GC is triggered. Can
+ * be changed at run time; 0 disables triggering.
+ */
+#ifndef JSMBED_EXTERNAL_MEMORY_GC_THRESHOLD
+#  define JSMBED_EXTERNAL_MEMORY_GC_THRESHOLD 2048
+#endif
+
+typedef struct {
+  uint32_t bytes;           // External memory currently held.
+  uint32_t peak_bytes;
+  uint32_t bytes_since_gc;  // Added since the last collection this triggered.
+  uint32_t threshold;
+  uint32_t gc_count;        // Collections triggered by external memory.
+} jsmbed_wrap_external_memory_stats_t;
+
+/*
+ * Reports memory held by a native object. May run the GC, so it must only be
+ * called from a binding, while the engine is running.
+ */
+void jsmbed_wrap_external_memory_add(size_t bytes);
+
+// Reports memory released by a native object. Safe to call from the GC.
+void jsmbed_wrap_external_memory_remove(size_t bytes);
+
+void jsmbed_wrap_external_memory_set_threshold(uint32_t threshold);
+
+void jsmbed_wrap_external_memory_get_stats(jsmbed_wrap_external_memory_stats_t *stats);
+
+#endif
@@ -22,45 +22,102 @@
 
 extern Mail<callback_message, 16> jsmbed_js_callback_mailbox;
 
+static osThreadId event_loop_thread = NULL;
+static uint32_t dropped_messages = 0;
+
+void jsmbed_wrap_set_event_loop_thread()
+{
+  event_loop_thread = osThreadGetId();
+}
+
+uint32_t jsmbed_wrap_get_dropped_message_count()
+{
+  return dropped_messages;
+}
+
+// !!! - Called in ISR code and from other threads - !!!
+//  = No printf.
+//
+// Other threads can wait for the event loop to make room in the mailbox. ISRs
+// can't, and neither can the event loop itself, since it's the one that would
+// have to empty it, so their messages are dropped and counted instead.
+static callback_message *jsmbed_wrap_alloc_message()
+{
+  callback_message *msg = jsmbed_js_callback_mailbox.alloc();
+  while (msg == NULL && __get_IPSR() == 0 && osThreadGetId() != event_loop_thread)
+  {
+    Thread::wait(1);
+    msg = jsmbed_js_callback_mailbox.alloc();
+  }
+
+  if (msg == NULL)
+  {
+    core_util_atomic_incr_u32(&dropped_messages, 1);
+  }
+  return msg;
+}
+
+// !!! - Called in ISR code - !!!
+//  = No printf.
+//
+// Dropping a message that carries a value has to release the value too,
+// the way the event loop would have after the call. Values posted from
+// ISRs are plain numbers and the like, which need no releasing, so the
+// jerryscript API is only used for objects and strings.
+static void jsmbed_wrap_drop_value(jerry_value_t *value)
+{
+  if (value->type == JERRY_DATA_TYPE_OBJECT || value->type == JERRY_DATA_TYPE_STRING)
+  {
+    jerry_release_value(value);
+  }
+}
+
 // !!! - Called in ISR code - !!!
 //  = No printf.
 void JSFunctionMailman::post_call_callback_msg()
 {
+  callback_message *msg = jsmbed_wrap_alloc_message();
+  if (msg == NULL)
+  {
+    return;
+  }
+
   if (javascript_function != NULL)
   {
-    callback_message *msg = jsmbed_js_callback_mailbox.alloc();
     msg->function = javascript_function;
     msg->action = CALL;
-    jsmbed_js_callback_mailbox.put(msg);
   }
   else
   {
-    callback_message *msg = jsmbed_js_callback_mailbox.alloc();
     msg->function = NULL;
     msg->action = ERROR_CORRUPT_JS_CALLBACK;
-    jsmbed_js_callback_mailbox.put(msg);
   }
+  jsmbed_js_callback_mailbox.put(msg);
 }
 
 // !!! - Called in ISR code - !!!
 //  = No printf.
 void JSFunctionMailman::post_call_callback_msg_1arg(jerry_value_t arg)
 {
+  callback_message *msg = jsmbed_wrap_alloc_message();
+  if (msg == NULL)
+  {
+    jsmbed_wrap_drop_value(&arg);
+    return;
+  }
+
   if (javascript_function != NULL)
   {
-    callback_message *msg = jsmbed_js_callback_mailbox.alloc();
     msg->function = javascript_function;
     msg->action = CALL_1ARG;
     msg->arg1_value = arg;
-    jsmbed_js_callback_mailbox.put(msg);
   }
   else
   {
-    callback_message *msg = jsmbed_js_callback_mailbox.alloc();
     msg->function = NULL;
     msg->action = ERROR_CORRUPT_JS_CALLBACK;
-    jsmbed_js_callback_mailbox.put(msg);
   }
+  jsmbed_js_callback_mailbox.put(msg);
 }
 
 // !!! - Called in ISR code - !!!
@@ -69,7 +126,11 @@ void JSFunctionMailman::post_call_callback_msg_string_arg(void* string_arg)
 {
   if (javascript_function == NULL)
   {
-    callback_message *msg = jsmbed_js_callback_mailbox.alloc();
+    callback_message *msg = jsmbed_wrap_alloc_message();
+    if (msg == NULL)
+    {
+      return;
+    }
     msg->function = NULL;
     msg->action = ERROR_CORRUPT_JS_CALLBACK;
     jsmbed_js_callback_mailbox.put(msg);
@@ -86,16 +147,46 @@ void JSFunctionMailman::post_call_callback_msg_string_arg(void* string_arg)
   post_call_callback_msg_1arg(js_string_val);
 }
 
+// !!! - Called in ISR code and from other threads - !!!
+//  = No printf.
+bool jsmbed_wrap_post_native_call(void (*native_function)(void *context), void *context)
+{
+  callback_message *msg = jsmbed_wrap_alloc_message();
+  if (msg == NULL)
+  {
+    return false;
+  }
+  msg->function = NULL;
+  msg->action = CALL_NATIVE;
+  msg->native_function = native_function;
+  msg->native_context = context;
+  jsmbed_js_callback_mailbox.put(msg);
+  return true;
+}
+
+// !!! - Called in ISR code - !!!
+//  = No printf.
+void jsmbed_wrap_post_release(jerry_object_t *object)
+{
+  callback_message *msg = jsmbed_wrap_alloc_message();
+  if (msg == NULL)
+  {
+    // The object leaks, which is better than releasing it while messages
+    // that refer to it may still be waiting.
+    return;
+  }
+  msg->function = object;
+  msg->action = RELEASE;
+  jsmbed_js_callback_mailbox.put(msg);
+}
+
 void JSFunctionMailman::post_release_callback_msg()
 {
   // Only need to delete the function if we got one.
   if (javascript_function != NULL)
   {
     LOG_PRINT("[MAILMAN] POST-RELEASE 0x%x\n", javascript_function);
-    callback_message *msg = jsmbed_js_callback_mailbox.alloc();
-    msg->function = javascript_function;
-    msg->action = RELEASE;
-    jsmbed_js_callback_mailbox.put(msg);
+    jsmbed_wrap_post_release(javascript_function);
     LOG_PRINT("[MAILMAN] POST-RELEASE-COMPLETE\n");
   }
 }
@@ -25,6 +25,7 @@ enum CallbackAction {
   CALL,
   CALL_1ARG,
   RELEASE,
+  CALL_NATIVE,
   ERROR_CORRUPT_JS_CALLBACK
 };
 
@@ -32,8 +33,41 @@ typedef struct {
   jerry_object_t *function;
   CallbackAction action;
   jerry_value_t arg1_value;
+  void (*native_function)(void *context);
+  void *native_context;
 } callback_message;
 
+/*
+ * Posts a native function to be called from the main event loop, i.e. on the
+ * JavaScript thread, where it is safe to use the jerryscript API. This is how
+ * work finished on other threads (or in ISRs) hands its results back.
+ *
+ * If the mailbox is full, other threads wait for room. Calls from ISRs or
+ * from the event loop itself are dropped instead (see
+ * jsmbed_wrap_get_dropped_message_count), and false is returned, so that
+ * the caller can undo anything it set up for the call.
+ */
+bool jsmbed_wrap_post_native_call(void (*native_function)(void *context), void *context);
+
+/*
+ * Releases an object from the main event loop, after every message already
+ * posted. Use this rather than releasing directly when messages that refer
+ * to the object may still be waiting. If the release has to be dropped, the
+ * object leaks.
+ */
+void jsmbed_wrap_post_release(jerry_object_t *object);
+
+/*
+ * Records the calling thread as the event loop, which must never wait for
+ * room in its own mailbox.
+ */
+void jsmbed_wrap_set_event_loop_thread();
+
+/*
+ * The number of messages dropped so far because the mailbox was full.
+ */
+uint32_t jsmbed_wrap_get_dropped_message_count();
+
 /*
  * This class stores a jerry_object_t, that represents
  * the function that should be executed from the main event loop
@@ -42,6 +76,10 @@ typedef struct {
  * This class is responsible for posting messages to the main
  * event loop indicating that the associated jerry_object_t should
  * be called or released.
+ *
+ * Messages go through the same mailbox as jsmbed_wrap_post_native_call, and
+ * are dropped and counted in the same cases. A dropped call releases its
+ * argument, as the event loop would have after calling.
  */
 class JSFunctionMailman
 {
@@ -0,0 +1,63 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include "jsmbed_wrap_keys.h"
+
+DECLARE_JS_KEY(length);
+
+static jsmbed_wrap_key_t *jsmbed_wrap_interned_keys = NULL;
+
+void jsmbed_wrap_intern_key(jsmbed_wrap_key_t *key)
+{
+  if (key->string != NULL)
+  {
+    return;
+  }
+
+  key->string = jerry_create_string_sz((const jerry_char_t *) key->name, key->size);
+  key->next = jsmbed_wrap_interned_keys;
+  jsmbed_wrap_interned_keys = key;
+}
+
+void jsmbed_wrap_intern_core_keys(void)
+{
+  INTERN_JS_KEY(length);
+}
+
+void jsmbed_wrap_release_keys(void)
+{
+  jsmbed_wrap_key_t *key = jsmbed_wrap_interned_keys;
+  while (key != NULL)
+  {
+    jsmbed_wrap_key_t *next = key->next;
+    jerry_release_string(key->string);
+    key->string = NULL;
+    key->next = NULL;
+    key = next;
+  }
+  jsmbed_wrap_interned_keys = NULL;
+}
+
+jerry_string_t *jsmbed_wrap_key_string(jsmbed_wrap_key_t *key)
+{
+  if (key->string == NULL)
+  {
+    // Not interned (or the engine has been restarted), so do it now.
+    jsmbed_wrap_intern_key(key);
+  }
+  return jerry_acquire_string(key->string);
+}
@@ -0,0 +1,89 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JSMBED_WRAP_KEYS_H__
+#define __JSMBED_WRAP_KEYS_H__
+
+#include "jerry-core/jerry.h"
+
+#include "jsmbed_wrap_name_macros.h"
+
+/*
+ * A property name that native code uses often enough that it is worth
+ * preparing once, rather than measuring and converting a C string on every
+ * access.
+ *
+ * The name and its size are fixed at compile time, and are what the field
+ * accessors (jsmbed_wrap_get_field/jsmbed_wrap_set_field) pass to the
+ * engine. Once interned, the key also holds a reference to an engine string
+ * for the name, for code that needs the name as a JS value.
+ */
+typedef struct jsmbed_wrap_key_t {
+  const char *name;
+  jerry_size_t size;
+  jerry_string_t *string;
+  struct jsmbed_wrap_key_t *next;
+} jsmbed_wrap_key_t;
+
+/*
+ * Defines a key, at file scope. For example
+ *
+ * DECLARE_JS_KEY(length);
+ * ...
+ * jsmbed_wrap_get_field(array, JS_KEY(length), &length_value);
+ */
+#define DECLARE_JS_KEY(NAME) \
+  jsmbed_wrap_key_t NAME_FOR_KEY(NAME) = { # NAME, sizeof(# NAME) - 1, NULL, NULL }
+
+// Makes a key defined in another file usable from this one.
+#define EXTERN_JS_KEY(NAME) \
+  extern jsmbed_wrap_key_t NAME_FOR_KEY(NAME)
+
+#define JS_KEY(NAME) (&NAME_FOR_KEY(NAME))
+
+// Should be called from a wrapper's registration function for its keys.
+#define INTERN_JS_KEY(NAME) \
+  jsmbed_wrap_intern_key(JS_KEY(NAME))
+
+// For C string literals, expands to the arguments the engine's _sz
+// functions take, with the size worked out at compile time.
+#define JSMBED_WRAP_SZ(LITERAL) \
+  (const jerry_char_t *) (LITERAL), (jerry_size_t) (sizeof(LITERAL) - 1)
+
+// Keys used by the wrapper API itself.
+EXTERN_JS_KEY(length);
+
+void jsmbed_wrap_intern_key(jsmbed_wrap_key_t *key);
+
+// Interns the keys used by the wrapper API. Called once the engine is up.
+void jsmbed_wrap_intern_core_keys(void);
+
+// Releases every interned key. Called before the engine is shut down.
+void jsmbed_wrap_release_keys(void);
+
+// Returns the name of a key as a new reference to an engine string.
+jerry_string_t *jsmbed_wrap_key_string(jsmbed_wrap_key_t *key);
+
+inline bool jsmbed_wrap_get_field(jerry_object_t *obj_p, const jsmbed_wrap_key_t *key, jerry_value_t *out_p)
+{
+  return jerry_get_object_field_value_sz(obj_p, (const jerry_char_t *) key->name, key->size, out_p);
+}
+
+inline bool jsmbed_wrap_set_field(jerry_object_t *obj_p, const jsmbed_wrap_key_t *key, const jerry_value_t *val_p)
+{
+  return jerry_set_object_field_value_sz(obj_p, (const jerry_char_t *) key->name, key->size, val_p);
+}
+
+#endif
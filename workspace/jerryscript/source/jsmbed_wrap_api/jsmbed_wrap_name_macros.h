@@ -20,6 +20,17 @@
 #define NAME_FOR_CLASS_CONSTRUCTOR(CLASS) __gen_jsmbed_class_constructor_ ## CLASS
 #define NAME_FOR_CLASS_FUNCTION(CLASS, NAME) __gen_jsmbed_func_c_ ## CLASS ## _f_ ## NAME
 
+#define NAME_FOR_GLOBAL_FUNCTION_BODY(NAME) __gen_jsmbed_global_func_body_ ## NAME
+#define NAME_FOR_CLASS_CONSTRUCTOR_BODY(CLASS) __gen_jsmbed_class_constructor_body_ ## CLASS
+#define NAME_FOR_CLASS_FUNCTION_BODY(CLASS, NAME) __gen_jsmbed_func_body_c_ ## CLASS ## _f_ ## NAME
+
+#define NAME_FOR_CLASS_FUNCTION_OVERLOAD(CLASS, NAME, SIG) __gen_jsmbed_func_c_ ## CLASS ## _f_ ## NAME ## _o_ ## SIG
+#define NAME_FOR_CLASS_FUNCTION_OVERLOADS(CLASS, NAME) __gen_jsmbed_overloads_c_ ## CLASS ## _f_ ## NAME
+
+#define NAME_FOR_KEY(NAME) __gen_jsmbed_key_ ## NAME
+#define NAME_FOR_SCHEMA(STRUCT) __gen_jsmbed_schema_ ## STRUCT
+#define NAME_FOR_SCHEMA_FIELDS(STRUCT) __gen_jsmbed_schema_fields_ ## STRUCT
+
 #define NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(CLASS, TYPELIST) __gen_native_jsmbed_ ## CLASS ## __Special_create_ ## TYPELIST
 #define NAME_FOR_CLASS_NATIVE_DESTRUCTOR(CLASS) __gen_native_jsmbed_ ## CLASS ## __Special_destroy
 #define NAME_FOR_CLASS_NATIVE_FUNCTION(CLASS, NAME) __gen_native_jsmbed_ ## CLASS ## _ ## NAME
@@ -0,0 +1,38 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JSMBED_WRAP_NATIVE_LINK_H__
+#define __JSMBED_WRAP_NATIVE_LINK_H__
+
+#include <stdint.h>
+
+typedef void (*jsmbed_wrap_free_function_t)(uintptr_t native_obj);
+
+/*
+ * Records the native object behind a JS object, and the function that frees
+ * it. Each native type has its own free function, so this is what tells a
+ * binding which type it has been passed, without reading the native object
+ * itself.
+ *
+ * Only types that bindings need to recognise have one. They keep it as a
+ * member, and are linked with jsmbed_wrap_link_typed_objects, so that no
+ * separate allocation is needed.
+ */
+typedef struct {
+  uintptr_t native_obj;
+  jsmbed_wrap_free_function_t free_function;
+} jsmbed_wrap_native_link_t;
+
+#endif
@@ -0,0 +1,95 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "jsmbed_wrap_log_macros.h"
+
+#include "jsmbed_wrap_object_pool.h"
+
+// Zero-initialised before any constructors run, so pools declared at file
+// scope in any translation unit can safely link themselves in.
+static JSObjectPoolBase *jsmbed_wrap_object_pools = NULL;
+
+JSObjectPoolBase *JSObjectPoolBase::get_first()
+{
+  return jsmbed_wrap_object_pools;
+}
+
+JSObjectPoolBase::JSObjectPoolBase(const char *name, void *slots, uint32_t slot_size, uint32_t capacity) :
+  name(name),
+  slots((uint8_t*) slots),
+  slot_size(slot_size),
+  capacity(capacity),
+  first_unused(0),
+  free_list(NULL),
+  in_use(0),
+  peak(0),
+  overflows(0),
+  next(jsmbed_wrap_object_pools)
+{
+  jsmbed_wrap_object_pools = this;
+}
+
+void *JSObjectPoolBase::alloc_slot()
+{
+  void *ptr;
+
+  if (free_list != NULL)
+  {
+    ptr = free_list;
+    free_list = *((void**) ptr);
+  }
+  else if (first_unused < capacity)
+  {
+    ptr = slots + first_unused * slot_size;
+    first_unused++;
+  }
+  else
+  {
+    LOG_PRINT("[POOL] OVERFLOW %s (%d slots)\n", name, capacity);
+    overflows++;
+    return malloc(slot_size);
+  }
+
+  in_use++;
+  if (in_use > peak)
+  {
+    peak = in_use;
+  }
+  return ptr;
+}
+
+void JSObjectPoolBase::free_slot(void *ptr)
+{
+  uint8_t *slot = (uint8_t*) ptr;
+
+  if (slot < slots || slot >= slots + capacity * slot_size)
+  {
+    // Allocated from the heap when the pool was full.
+    free(ptr);
+    return;
+  }
+
+  *((void**) ptr) = free_list;
+  free_list = ptr;
+  in_use--;
+}
+
+void JSObjectPoolBase::report_exhausted() const
+{
+  LOG_PRINT_ALWAYS("ERROR: Out of memory for %s.\n", name);
+}
@@ -0,0 +1,168 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JSMBED_WRAP_OBJECT_POOL_H__
+#define __JSMBED_WRAP_OBJECT_POOL_H__
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "jsmbed_wrap_external_memory.h"
+
+/*
+ * The untyped part of JSObjectPool, which does all of the bookkeeping so
+ * that it isn't duplicated for every type that gets a pool.
+ *
+ * Every pool links itself into a list when it is constructed, so that
+ * occupancy can be reported for all pools without knowing their types.
+ */
+class JSObjectPoolBase
+{
+public:
+  const char *get_name() const { return name; }
+  uint32_t get_capacity() const { return capacity; }
+  uint32_t get_in_use() const { return in_use; }
+  uint32_t get_peak() const { return peak; }
+  uint32_t get_overflows() const { return overflows; }
+
+  JSObjectPoolBase *get_next() const { return next; }
+  static JSObjectPoolBase *get_first();
+
+protected:
+  JSObjectPoolBase(const char *name, void *slots, uint32_t slot_size, uint32_t capacity);
+
+  // O(1). When the pool is full, falls back to the heap and counts an overflow.
+  void *alloc_slot();
+  void free_slot(void *ptr);
+
+  // For when even the heap fallback fails.
+  void report_exhausted() const;
+
+private:
+  const char *name;
+  uint8_t *slots;
+  uint32_t slot_size;
+  uint32_t capacity;
+
+  // Slots below this index have been handed out at least once, and are
+  // either in use or on the free list. Slots above it have never been used.
+  uint32_t first_unused;
+  void *free_list;
+
+  uint32_t in_use;
+  uint32_t peak;
+  uint32_t overflows;
+
+  JSObjectPoolBase *next;
+};
+
+/*
+ * A fixed-size pool of N objects of type T, with O(1) allocation and
+ * release, and no heap fragmentation while it has free slots.
+ *
+ * Typically declared at file scope next to the native functions that use it:
+ *
+ * static JSObjectPool<DigitalOut, 8> digital_out_pool("DigitalOut");
+ *
+ * DigitalOut *pin = digital_out_pool.construct(LED1);
+ * if (pin == NULL) ...
+ * digital_out_pool.destroy(pin);
+ *
+ * Objects are reported as external memory while they are alive, whether or
+ * not they fit in the pool, since a full pool spills onto the heap and the
+ * GC is what gives slots back.
+ */
+template<typename T, uint32_t N>
+class JSObjectPool : public JSObjectPoolBase
+{
+public:
+  JSObjectPool(const char *name) :
+    JSObjectPoolBase(name, storage, sizeof(slot), N)
+  {
+  }
+
+  void *alloc()
+  {
+    // First, so that if this triggers a GC, the slots it frees can be reused.
+    jsmbed_wrap_external_memory_add(sizeof(T));
+    void *ptr = alloc_slot();
+    if (ptr == NULL)
+    {
+      // The heap fallback failed too.
+      jsmbed_wrap_external_memory_remove(sizeof(T));
+      report_exhausted();
+    }
+    return ptr;
+  }
+
+  // Allocates a slot and constructs a T in it, with up to four arguments.
+  // Returns NULL, having reported it, once the pool and the heap are both
+  // exhausted, so callers only need to check the result.
+  T *construct()
+  {
+    void *ptr = alloc();
+    return (ptr != NULL) ? new (ptr) T() : NULL;
+  }
+
+  template<typename A1>
+  T *construct(A1 a1)
+  {
+    void *ptr = alloc();
+    return (ptr != NULL) ? new (ptr) T(a1) : NULL;
+  }
+
+  template<typename A1, typename A2>
+  T *construct(A1 a1, A2 a2)
+  {
+    void *ptr = alloc();
+    return (ptr != NULL) ? new (ptr) T(a1, a2) : NULL;
+  }
+
+  template<typename A1, typename A2, typename A3>
+  T *construct(A1 a1, A2 a2, A3 a3)
+  {
+    void *ptr = alloc();
+    return (ptr != NULL) ? new (ptr) T(a1, a2, a3) : NULL;
+  }
+
+  template<typename A1, typename A2, typename A3, typename A4>
+  T *construct(A1 a1, A2 a2, A3 a3, A4 a4)
+  {
+    void *ptr = alloc();
+    return (ptr != NULL) ? new (ptr) T(a1, a2, a3, a4) : NULL;
+  }
+
+  void destroy(T *obj)
+  {
+    if (obj != NULL)
+    {
+      obj->~T();
+      free_slot(obj);
+      jsmbed_wrap_external_memory_remove(sizeof(T));
+    }
+  }
+
+private:
+  union slot {
+    uint64_t alignment;
+    void *next_free;
+    uint8_t bytes[sizeof(T)];
+  };
+
+  slot storage[N];
+};
+
+#endif
@@ -0,0 +1,196 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include "jsmbed_wrap_typed_array.h"
+
+#include "jsmbed_wrap_overload.h"
+
+// What an argument can be used as. An object that is a function, for
+// example, is both ARG_OBJECT and ARG_FUNCTION.
+enum {
+  ARG_NUMBER = (1 << 0),
+  ARG_BOOLEAN = (1 << 1),
+  ARG_STRING = (1 << 2),
+  ARG_OBJECT = (1 << 3),
+  ARG_FUNCTION = (1 << 4),
+  ARG_TYPED_ARRAY = (1 << 5),
+  ARG_NULL = (1 << 6),
+  ARG_ANY = 0xFF
+};
+
+static uint8_t classify_argument(const jerry_value_t *val_p)
+{
+  switch (val_p->type)
+  {
+    case JERRY_DATA_TYPE_UINT32:
+    case JERRY_DATA_TYPE_FLOAT32:
+    case JERRY_DATA_TYPE_FLOAT64:
+      return ARG_NUMBER;
+    case JERRY_DATA_TYPE_BOOLEAN:
+      return ARG_BOOLEAN;
+    case JERRY_DATA_TYPE_STRING:
+      return ARG_STRING;
+    case JERRY_DATA_TYPE_NULL:
+      return ARG_NULL;
+    case JERRY_DATA_TYPE_OBJECT:
+    {
+      uint8_t result = ARG_OBJECT;
+      if (jerry_is_function(val_p->u.v_object))
+      {
+        result |= ARG_FUNCTION;
+      }
+      else if (jsmbed_wrap_get_typed_array(val_p) != NULL)
+      {
+        result |= ARG_TYPED_ARRAY;
+      }
+      return result;
+    }
+    default:
+      return 0;
+  }
+}
+
+/*
+ * Returns what the argument must be usable as for a type character, and
+ * how much it adds to the score when it is.
+ */
+static uint8_t expected_argument(char arg_type, int *weight)
+{
+  *weight = 2;
+  switch (arg_type)
+  {
+    case 'n':
+      return ARG_NUMBER;
+    case 'b':
+      return ARG_BOOLEAN;
+    case 's':
+      return ARG_STRING;
+    case 'z':
+      return ARG_NULL;
+    case 'f':
+      *weight = 3;
+      return ARG_FUNCTION;
+    case 't':
+      *weight = 3;
+      return ARG_TYPED_ARRAY;
+    case 'o':
+      return ARG_OBJECT;
+    case '*':
+      *weight = 1;
+      return ARG_ANY;
+    default:
+      *weight = 0;
+      return 0;
+  }
+}
+
+// Returns -1 if the overload can't accept the arguments.
+static int score_overload(const char *arg_types, const uint8_t arg_classes[], jerry_length_t args_count)
+{
+  int score = 0;
+  jerry_length_t required = 0;
+  jerry_length_t index = 0;
+  bool optional = false;
+
+  for (const char *arg_type = arg_types; *arg_type != '\0'; arg_type++)
+  {
+    if (*arg_type == '|')
+    {
+      optional = true;
+      continue;
+    }
+
+    if (index >= args_count)
+    {
+      if (!optional)
+      {
+        return -1;
+      }
+      index++;
+      continue;
+    }
+
+    int weight;
+    uint8_t expected = expected_argument(*arg_type, &weight);
+    if ((arg_classes[index] & expected) == 0)
+    {
+      return -1;
+    }
+
+    score += weight;
+    index++;
+    if (!optional)
+    {
+      required = index;
+    }
+  }
+
+  // index is now the maximum number of arguments the overload takes.
+  if (args_count > index || args_count < required)
+  {
+    return -1;
+  }
+  return score;
+}
+
+bool jsmbed_wrap_dispatch_overload(const char *class_name,
+                                   const char *name,
+                                   const jsmbed_wrap_overload_t *overloads,
+                                   int overload_count,
+                                   const jerry_object_t * function_obj_p,
+                                   const jerry_value_t *  this_p,
+                                   jerry_value_t *        ret_val_p,
+                                   const jerry_value_t    args_p[],
+                                   const jerry_length_t   args_count)
+{
+  if (args_count > JSMBED_WRAP_MAX_OVERLOAD_ARGS)
+  {
+    printf("ERROR: too many arguments for %s.%s.\n", class_name, name);
+    return false;
+  }
+
+  uint8_t arg_classes[JSMBED_WRAP_MAX_OVERLOAD_ARGS];
+  for (jerry_length_t index = 0; index < args_count; index++)
+  {
+    arg_classes[index] = classify_argument(&args_p[index]);
+  }
+
+  int best_overload = -1;
+  int best_score = -1;
+  for (int overload = 0; overload < overload_count; overload++)
+  {
+    int score = score_overload(overloads[overload].arg_types, arg_classes, args_count);
+    if (score > best_score)
+    {
+      best_score = score;
+      best_overload = overload;
+    }
+  }
+
+  if (best_overload < 0)
+  {
+    printf("ERROR: no overload of %s.%s accepts these arguments, expected one of:", class_name, name);
+    for (int overload = 0; overload < overload_count; overload++)
+    {
+      printf(" (%s)", overloads[overload].arg_types);
+    }
+    printf("\n");
+    return false;
+  }
+
+  return overloads[best_overload].shim(function_obj_p, this_p, ret_val_p, args_p, args_count);
+}
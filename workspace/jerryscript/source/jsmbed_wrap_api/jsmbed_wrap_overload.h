@@ -0,0 +1,104 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JSMBED_WRAP_OVERLOAD_H__
+#define __JSMBED_WRAP_OVERLOAD_H__
+
+#include "jerry-core/jerry.h"
+
+#include "jsmbed_wrap_name_macros.h"
+
+/*
+ * Table-driven dispatch for overloaded methods.
+ *
+ * Each overload is a shim with the usual handler signature, plus a string
+ * describing the argument types it accepts, one character per argument:
+ *
+ *   n - number           b - boolean        s - string
+ *   o - any object       f - function       t - typed array
+ *   z - null             * - anything
+ *   | - all of the following arguments are optional
+ *
+ * e.g. "non|b" is (number, object, number[, boolean]).
+ *
+ * The dispatcher classifies each argument once, scores every overload
+ * against those classifications, and calls the best match. More specific
+ * types (function, typed array) score higher than a plain object, so they
+ * can be given their own overloads. Shims can then unbox their arguments
+ * without checking them again.
+ *
+ * For example:
+ *
+ * DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, read, I) { ... }
+ * DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, read, I_PC_I_B) { ... }
+ *
+ * DECLARE_CLASS_FUNCTION_OVERLOADS(I2C, read)
+ * {
+ *   CLASS_FUNCTION_OVERLOAD(I2C, read, I, "n"),
+ *   CLASS_FUNCTION_OVERLOAD(I2C, read, I_PC_I_B, "non|b")
+ * };
+ *
+ * DISPATCH_CLASS_FUNCTION_OVERLOADS(I2C, read)
+ */
+
+// Overloads with more arguments than this can never be selected.
+#define JSMBED_WRAP_MAX_OVERLOAD_ARGS 8
+
+typedef bool (*jsmbed_wrap_overload_shim_t) (const jerry_object_t * function_obj_p,
+                                             const jerry_value_t *  this_p,
+                                             jerry_value_t *        ret_val_p,
+                                             const jerry_value_t    args_p[],
+                                             const jerry_length_t   args_count);
+
+typedef struct {
+  const char *arg_types;
+  jsmbed_wrap_overload_shim_t shim;
+} jsmbed_wrap_overload_t;
+
+#define DECLARE_CLASS_FUNCTION_OVERLOAD(CLASS, NAME, SIG) \
+static bool \
+NAME_FOR_CLASS_FUNCTION_OVERLOAD(CLASS, NAME, SIG) (const jerry_object_t * function_obj_p, \
+                  const jerry_value_t *  this_p, \
+                  jerry_value_t *        ret_val_p, \
+                  const jerry_value_t    args_p[], \
+                  const jerry_length_t   args_count)
+
+#define DECLARE_CLASS_FUNCTION_OVERLOADS(CLASS, NAME) \
+  static const jsmbed_wrap_overload_t NAME_FOR_CLASS_FUNCTION_OVERLOADS(CLASS, NAME)[] =
+
+#define CLASS_FUNCTION_OVERLOAD(CLASS, NAME, SIG, ARG_TYPES) \
+  { ARG_TYPES, NAME_FOR_CLASS_FUNCTION_OVERLOAD(CLASS, NAME, SIG) }
+
+// Defines the binding for CLASS.NAME, which dispatches to the overloads.
+#define DISPATCH_CLASS_FUNCTION_OVERLOADS(CLASS, NAME) \
+  DECLARE_CLASS_FUNCTION(CLASS, NAME) \
+  { \
+    return jsmbed_wrap_dispatch_overload(# CLASS, # NAME, \
+        NAME_FOR_CLASS_FUNCTION_OVERLOADS(CLASS, NAME), \
+        sizeof(NAME_FOR_CLASS_FUNCTION_OVERLOADS(CLASS, NAME)) / sizeof(jsmbed_wrap_overload_t), \
+        function_obj_p, this_p, ret_val_p, args_p, args_count); \
+  }
+
+bool jsmbed_wrap_dispatch_overload(const char *class_name,
+                                   const char *name,
+                                   const jsmbed_wrap_overload_t *overloads,
+                                   int overload_count,
+                                   const jerry_object_t * function_obj_p,
+                                   const jerry_value_t *  this_p,
+                                   jerry_value_t *        ret_val_p,
+                                   const jerry_value_t    args_p[],
+                                   const jerry_length_t   args_count);
+
+#endif
@@ -0,0 +1,79 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include "hal/hal/us_ticker_api.h"
+
+#include "jsmbed_wrap_profile.h"
+
+static jsmbed_wrap_profile_entry_t *jsmbed_wrap_profile_entries = NULL;
+
+jsmbed_wrap_profile_entry_t *jsmbed_wrap_profile_get_first(void)
+{
+  return jsmbed_wrap_profile_entries;
+}
+
+void jsmbed_wrap_profile_print(void)
+{
+  printf("%-32s %10s %12s %8s %8s\r\n", "binding", "calls", "total us", "mean us", "max us");
+  for (jsmbed_wrap_profile_entry_t *entry = jsmbed_wrap_profile_entries; entry != NULL; entry = entry->next)
+  {
+    char name[33];
+    snprintf(name, sizeof(name), "%s.%s", entry->class_name, entry->name);
+    printf("%-32s %10lu %12lu %8lu %8lu\r\n",
+        name,
+        (unsigned long) entry->calls,
+        (unsigned long) entry->total_us,
+        (unsigned long) (entry->calls ? entry->total_us / entry->calls : 0),
+        (unsigned long) entry->max_us);
+  }
+}
+
+void jsmbed_wrap_profile_reset(void)
+{
+  for (jsmbed_wrap_profile_entry_t *entry = jsmbed_wrap_profile_entries; entry != NULL; entry = entry->next)
+  {
+    entry->calls = 0;
+    entry->total_us = 0;
+    entry->max_us = 0;
+  }
+}
+
+JSProfileScope::JSProfileScope(jsmbed_wrap_profile_entry_t *entry) :
+  entry(entry),
+  start_us(us_ticker_read())
+{
+}
+
+JSProfileScope::~JSProfileScope()
+{
+  // Unsigned subtraction, so this is still right if the ticker wrapped.
+  uint32_t elapsed_us = us_ticker_read() - start_us;
+
+  if (!entry->linked)
+  {
+    entry->next = jsmbed_wrap_profile_entries;
+    jsmbed_wrap_profile_entries = entry;
+    entry->linked = true;
+  }
+
+  entry->calls++;
+  entry->total_us += elapsed_us;
+  if (elapsed_us > entry->max_us)
+  {
+    entry->max_us = elapsed_us;
+  }
+}
@@ -0,0 +1,73 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JSMBED_WRAP_PROFILE_H__
+#define __JSMBED_WRAP_PROFILE_H__
+
+#include <stdint.h>
+
+/*
+ * Per-binding call counters and timing.
+ *
+ * Define JSMBED_PROFILE_BINDINGS to have every binding declared with the
+ * DECLARE_*_FUNCTION macros count its calls and the time spent in it. The
+ * time includes anything the binding calls, including JavaScript callbacks
+ * and other bindings. Without the define, none of this is compiled into the
+ * bindings, and the table below is always empty.
+ */
+typedef struct jsmbed_wrap_profile_entry_t {
+  const char *class_name;
+  const char *name;
+  uint32_t calls;
+  uint32_t total_us;
+  uint32_t max_us;
+  // Entries are linked into the table on their first call.
+  struct jsmbed_wrap_profile_entry_t *next;
+  bool linked;
+} jsmbed_wrap_profile_entry_t;
+
+// The first entry in the table, or NULL if no profiled binding has been called.
+jsmbed_wrap_profile_entry_t *jsmbed_wrap_profile_get_first(void);
+
+// Prints the table to the console.
+void jsmbed_wrap_profile_print(void);
+
+// Zeroes the counters of every entry.
+void jsmbed_wrap_profile_reset(void);
+
+/*
+ * Times the enclosing scope, and adds it to an entry. Used by the binding
+ * trampolines, through JSMBED_WRAP_PROFILE_SCOPE.
+ */
+class JSProfileScope
+{
+public:
+  JSProfileScope(jsmbed_wrap_profile_entry_t *entry);
+  ~JSProfileScope();
+
+private:
+  jsmbed_wrap_profile_entry_t *entry;
+  uint32_t start_us;
+};
+
+#ifdef JSMBED_PROFILE_BINDINGS
+#  define JSMBED_WRAP_PROFILE_SCOPE(CLASS_NAME, NAME) \
+  static jsmbed_wrap_profile_entry_t profile_entry = { CLASS_NAME, NAME, 0, 0, 0, NULL, false }; \
+  JSProfileScope profile_scope(&profile_entry)
+#else
+#  define JSMBED_WRAP_PROFILE_SCOPE(CLASS_NAME, NAME) do { } while (0)
+#endif
+
+#endif
@@ -13,32 +13,27 @@
  * limitations under the License.
  */
 
-#include <stdio.h>
+#include "jsmbed_wrap_tools.h"
 
 #include "jsmbed_wrap_registry.h"
 
-static const int jsmbed_wrap_registry_max_size = 64;
-static int jsmbed_wrap_registry_count = 0;
-static void (*jsmbed_wrap_registry_table[jsmbed_wrap_registry_max_size])(void) = { 0 };
+#define DECLARE_PACKAGE_REGISTRATION(NAME) \
+  DECLARE_JS_WRAPPER_REGISTRATION(NAME);
+
+#define PACKAGE_REGISTRY_ENTRY(NAME) \
+  jsmbed_wrap_registry_entry__ ## NAME,
+
+JSMBED_WRAP_PACKAGES(DECLARE_PACKAGE_REGISTRATION)
+
+static void (* const jsmbed_wrap_registry_table[])(void) = {
+  JSMBED_WRAP_PACKAGES(PACKAGE_REGISTRY_ENTRY)
+};
 
 void jsmbed_wrap_register_all_functions (void)
 {
-  for (int idx = 0; idx < jsmbed_wrap_registry_count; idx++)
+  const int count = sizeof(jsmbed_wrap_registry_table) / sizeof(jsmbed_wrap_registry_table[0]);
+  for (int idx = 0; idx < count; idx++)
   {
     (*jsmbed_wrap_registry_table[idx])();
   }
 }
-
-void jsmbed_wrap_register_wrapper (void (*wrapper)(void))
-{
-  if (jsmbed_wrap_registry_count < jsmbed_wrap_registry_max_size)
-  {
-    jsmbed_wrap_registry_table[jsmbed_wrap_registry_count] = wrapper;
-    jsmbed_wrap_registry_count++;
-  }
-  else
-  {
-    printf("Currently limited to %d wrapper libraries being registered, so ignoring this one.\n",
-        jsmbed_wrap_registry_max_size);
-  }
-}
@@ -17,24 +17,21 @@
 #define __JSMBED_WRAP_REGISTRY_H__
 
 /*
- * Before jsmbed_js_launch is used in a program, this macro should be
- * called to register any wrappers that will be used by the JavaScript program.
+ * The wrapper packages that are registered with the JavaScript engine when it
+ * starts. The registry is a const table built from this list at compile time,
+ * so it lives in flash and needs no setup before jsmbed_js_launch.
  *
- * For example
- * int main()
- * {
- *   JSMBED_USE_WRAPPER(base);
- *   JSMBED_USE_WRAPPER(lwip_interface);
- *   JSMBED_USE_WRAPPER(simple_mbed_client);
- *   jsmbed_js_launch();
- *   return 0;
- * }
+ * Each package only needs to provide its DECLARE_JS_WRAPPER_REGISTRATION
+ * function. A board build that needs a different set of packages can define
+ * the list itself, e.g. in mbed_app.json:
+ *
+ * "macros": ["JSMBED_WRAP_PACKAGES(PACKAGE)=PACKAGE(base) PACKAGE(lwip_interface)"]
  */
-#define JSMBED_USE_WRAPPER(NAME) \
-  jsmbed_wrap_register_wrapper(jsmbed_wrap_registry_entry__ ## NAME)
+#ifndef JSMBED_WRAP_PACKAGES
+#define JSMBED_WRAP_PACKAGES(PACKAGE) \
+  PACKAGE(base)
+#endif
 
 void jsmbed_wrap_register_all_functions (void);
 
-void jsmbed_wrap_register_wrapper (void (*wrapper)(void));
-
 #endif
@@ -0,0 +1,191 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include "jsmbed_wrap_tools.h"
+
+#include "jsmbed_wrap_schema.h"
+
+#define FIELD_PTR(TYPE, BASE, FIELD) \
+  ((TYPE *) ((uint8_t *) (BASE) + (FIELD)->offset))
+
+#define CONST_FIELD_PTR(TYPE, BASE, FIELD) \
+  ((const TYPE *) ((const uint8_t *) (BASE) + (FIELD)->offset))
+
+static void box_field(const jsmbed_wrap_field_t *field, const void *src, jerry_value_t *val_p)
+{
+  switch (field->type)
+  {
+    case JSMBED_WRAP_FIELD_BOOL:
+      jsmbed_wrap_box_boolean(val_p, *CONST_FIELD_PTR(bool, src, field));
+      break;
+    case JSMBED_WRAP_FIELD_UINT8:
+      jsmbed_wrap_box_uint32(val_p, *CONST_FIELD_PTR(uint8_t, src, field));
+      break;
+    case JSMBED_WRAP_FIELD_INT8:
+      jsmbed_wrap_box_number(val_p, *CONST_FIELD_PTR(int8_t, src, field));
+      break;
+    case JSMBED_WRAP_FIELD_UINT16:
+      jsmbed_wrap_box_uint32(val_p, *CONST_FIELD_PTR(uint16_t, src, field));
+      break;
+    case JSMBED_WRAP_FIELD_INT16:
+      jsmbed_wrap_box_number(val_p, *CONST_FIELD_PTR(int16_t, src, field));
+      break;
+    case JSMBED_WRAP_FIELD_UINT32:
+      jsmbed_wrap_box_uint32(val_p, *CONST_FIELD_PTR(uint32_t, src, field));
+      break;
+    case JSMBED_WRAP_FIELD_INT32:
+      jsmbed_wrap_box_number(val_p, *CONST_FIELD_PTR(int32_t, src, field));
+      break;
+    case JSMBED_WRAP_FIELD_FLOAT:
+      jsmbed_wrap_box_number(val_p, *CONST_FIELD_PTR(float, src, field));
+      break;
+    case JSMBED_WRAP_FIELD_DOUBLE:
+      jsmbed_wrap_box_number(val_p, *CONST_FIELD_PTR(double, src, field));
+      break;
+    default:
+      jsmbed_wrap_box_undefined(val_p);
+      break;
+  }
+}
+
+static bool unbox_field(const jsmbed_wrap_field_t *field, const jerry_value_t *val_p, void *dst)
+{
+  if (field->type == JSMBED_WRAP_FIELD_BOOL)
+  {
+    if (!jsmbed_wrap_value_is_boolean(val_p))
+    {
+      return false;
+    }
+    *FIELD_PTR(bool, dst, field) = jsmbed_wrap_unbox_boolean(val_p);
+    return true;
+  }
+
+  if (!jsmbed_wrap_value_is_number(val_p))
+  {
+    return false;
+  }
+
+  double value = jsmbed_wrap_unbox_number(val_p);
+  switch (field->type)
+  {
+    case JSMBED_WRAP_FIELD_UINT8:
+      *FIELD_PTR(uint8_t, dst, field) = (uint8_t) (int32_t) value;
+      break;
+    case JSMBED_WRAP_FIELD_INT8:
+      *FIELD_PTR(int8_t, dst, field) = (int8_t) (int32_t) value;
+      break;
+    case JSMBED_WRAP_FIELD_UINT16:
+      *FIELD_PTR(uint16_t, dst, field) = (uint16_t) (int32_t) value;
+      break;
+    case JSMBED_WRAP_FIELD_INT16:
+      *FIELD_PTR(int16_t, dst, field) = (int16_t) (int32_t) value;
+      break;
+    case JSMBED_WRAP_FIELD_UINT32:
+      *FIELD_PTR(uint32_t, dst, field) = (uint32_t) value;
+      break;
+    case JSMBED_WRAP_FIELD_INT32:
+      *FIELD_PTR(int32_t, dst, field) = (int32_t) value;
+      break;
+    case JSMBED_WRAP_FIELD_FLOAT:
+      *FIELD_PTR(float, dst, field) = (float) value;
+      break;
+    case JSMBED_WRAP_FIELD_DOUBLE:
+      *FIELD_PTR(double, dst, field) = value;
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+void jsmbed_wrap_intern_schema(jsmbed_wrap_schema_t *schema)
+{
+  for (uint32_t i = 0; i < schema->field_count; i++)
+  {
+    jsmbed_wrap_intern_key(&schema->fields[i].key);
+  }
+}
+
+jerry_object_t *jsmbed_wrap_struct_to_object(const jsmbed_wrap_schema_t *schema, const void *src)
+{
+  jerry_object_t *obj_p = jsmbed_wrap_create_object();
+  jsmbed_wrap_fill_object(schema, src, obj_p);
+  return obj_p;
+}
+
+bool jsmbed_wrap_fill_object(const jsmbed_wrap_schema_t *schema, const void *src, jerry_object_t *obj_p)
+{
+  for (uint32_t i = 0; i < schema->field_count; i++)
+  {
+    const jsmbed_wrap_field_t *field = &schema->fields[i];
+
+    jerry_value_t field_value;
+    box_field(field, src, &field_value);
+    if (!jsmbed_wrap_set_field(obj_p, &field->key, &field_value))
+    {
+      printf("ERROR: failed to set %s.%s.\n", schema->name, field->key.name);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool jsmbed_wrap_fill_object_property(const jsmbed_wrap_schema_t *schema, const void *src,
+                                      jerry_object_t *parent_p, const char *name)
+{
+  jerry_value_t child_value;
+  if (jerry_get_object_field_value(parent_p, (const jerry_char_t *) name, &child_value))
+  {
+    if (jsmbed_wrap_value_is_object(&child_value))
+    {
+      bool result = jsmbed_wrap_fill_object(schema, src, jsmbed_wrap_unbox_object(&child_value));
+      jerry_release_value(&child_value);
+      return result;
+    }
+    jerry_release_value(&child_value);
+  }
+
+  jerry_object_t *child_p = jsmbed_wrap_struct_to_object(schema, src);
+  jsmbed_wrap_box_object(&child_value, child_p);
+  bool result = jerry_set_object_field_value(parent_p, (const jerry_char_t *) name, &child_value);
+  jsmbed_wrap_release_object(child_p);
+  return result;
+}
+
+bool jsmbed_wrap_object_to_struct(const jsmbed_wrap_schema_t *schema, jerry_object_t *obj_p, void *dst)
+{
+  for (uint32_t i = 0; i < schema->field_count; i++)
+  {
+    const jsmbed_wrap_field_t *field = &schema->fields[i];
+
+    jerry_value_t field_value;
+    if (!jsmbed_wrap_get_field(obj_p, &field->key, &field_value))
+    {
+      printf("ERROR: %s.%s is missing.\n", schema->name, field->key.name);
+      return false;
+    }
+
+    bool result = unbox_field(field, &field_value, dst);
+    jerry_release_value(&field_value);
+    if (!result)
+    {
+      printf("ERROR: %s.%s has the wrong type.\n", schema->name, field->key.name);
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,123 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JSMBED_WRAP_SCHEMA_H__
+#define __JSMBED_WRAP_SCHEMA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "jerry-core/jerry.h"
+
+#include "jsmbed_wrap_keys.h"
+#include "jsmbed_wrap_name_macros.h"
+
+/*
+ * Schemas describe the fields of a C struct (name, type and offset), so that
+ * the struct can be converted to a JS object, or written into an existing
+ * one, without spelling out each field by hand. Every field carries its own
+ * key, so names are never measured or converted at run time.
+ *
+ * For example:
+ *
+ * typedef struct {
+ *   int16_t x;
+ *   int16_t y;
+ *   int16_t z;
+ *   uint32_t timestamp;
+ * } accel_sample_t;
+ *
+ * DECLARE_JS_SCHEMA_FIELDS(accel_sample_t)
+ * {
+ *   JS_SCHEMA_FIELD(accel_sample_t, x, INT16),
+ *   JS_SCHEMA_FIELD(accel_sample_t, y, INT16),
+ *   JS_SCHEMA_FIELD(accel_sample_t, z, INT16),
+ *   JS_SCHEMA_FIELD(accel_sample_t, timestamp, UINT32)
+ * };
+ * DECLARE_JS_SCHEMA(accel_sample_t);
+ *
+ * INTERN_JS_SCHEMA(accel_sample_t);   // in the wrapper's registration
+ * ...
+ * jerry_object_t *sample_obj = jsmbed_wrap_struct_to_object(JS_SCHEMA(accel_sample_t), &sample);
+ */
+typedef enum {
+  JSMBED_WRAP_FIELD_BOOL,
+  JSMBED_WRAP_FIELD_UINT8,
+  JSMBED_WRAP_FIELD_INT8,
+  JSMBED_WRAP_FIELD_UINT16,
+  JSMBED_WRAP_FIELD_INT16,
+  JSMBED_WRAP_FIELD_UINT32,
+  JSMBED_WRAP_FIELD_INT32,
+  JSMBED_WRAP_FIELD_FLOAT,
+  JSMBED_WRAP_FIELD_DOUBLE
+} jsmbed_wrap_field_type_t;
+
+typedef struct {
+  jsmbed_wrap_key_t key;
+  jsmbed_wrap_field_type_t type;
+  uint16_t offset;
+} jsmbed_wrap_field_t;
+
+typedef struct {
+  const char *name;
+  jsmbed_wrap_field_t *fields;
+  uint32_t field_count;
+} jsmbed_wrap_schema_t;
+
+#define DECLARE_JS_SCHEMA_FIELDS(STRUCT) \
+  static jsmbed_wrap_field_t NAME_FOR_SCHEMA_FIELDS(STRUCT)[] =
+
+#define JS_SCHEMA_FIELD(STRUCT, FIELD, TYPE) \
+  { { # FIELD, sizeof(# FIELD) - 1, NULL, NULL }, JSMBED_WRAP_FIELD_ ## TYPE, offsetof(STRUCT, FIELD) }
+
+#define DECLARE_JS_SCHEMA(STRUCT) \
+  static jsmbed_wrap_schema_t NAME_FOR_SCHEMA(STRUCT) = { \
+    # STRUCT, \
+    NAME_FOR_SCHEMA_FIELDS(STRUCT), \
+    sizeof(NAME_FOR_SCHEMA_FIELDS(STRUCT)) / sizeof(jsmbed_wrap_field_t) \
+  }
+
+#define JS_SCHEMA(STRUCT) (&NAME_FOR_SCHEMA(STRUCT))
+
+// Should be called from a wrapper's registration function for its schemas.
+#define INTERN_JS_SCHEMA(STRUCT) \
+  jsmbed_wrap_intern_schema(JS_SCHEMA(STRUCT))
+
+void jsmbed_wrap_intern_schema(jsmbed_wrap_schema_t *schema);
+
+// Returns a new object with a property for every field of the struct.
+jerry_object_t *jsmbed_wrap_struct_to_object(const jsmbed_wrap_schema_t *schema, const void *src);
+
+/*
+ * Writes every field of the struct into an existing object. Objects that are
+ * refilled on every sample keep their properties, so only the values change.
+ */
+bool jsmbed_wrap_fill_object(const jsmbed_wrap_schema_t *schema, const void *src, jerry_object_t *obj_p);
+
+/*
+ * Fills the object in the named property of PARENT, creating it first if the
+ * property isn't already an object. Used to refill tables of results that a
+ * caller passes back in, e.g. { "DigitalOut": { ... }, "I2C": { ... } }.
+ */
+bool jsmbed_wrap_fill_object_property(const jsmbed_wrap_schema_t *schema, const void *src,
+                                      jerry_object_t *parent_p, const char *name);
+
+/*
+ * Reads the struct back from an object. Fails, leaving the remaining fields
+ * untouched, on the first field that is missing or has the wrong type.
+ */
+bool jsmbed_wrap_object_to_struct(const jsmbed_wrap_schema_t *schema, jerry_object_t *obj_p, void *dst);
+
+#endif
@@ -0,0 +1,129 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "jsmbed_wrap_log_macros.h"
+
+#include "jsmbed_wrap_scratch_arena.h"
+
+// Every allocation is rounded up to this, so any type can be stored.
+static const size_t scratch_alignment = 8;
+
+// Heap fallbacks are prefixed with this, so that the ones made inside a
+// binding can be chained together and released when it returns.
+typedef struct fallback_header {
+  struct fallback_header *next;
+  uint32_t scoped;
+} fallback_header;
+
+static const size_t fallback_header_size =
+  (sizeof(fallback_header) + scratch_alignment - 1) & ~(scratch_alignment - 1);
+
+static uint64_t scratch_arena[(JSMBED_SCRATCH_ARENA_SIZE + 7) / 8];
+static size_t scratch_offset = 0;
+static fallback_header *scratch_fallbacks = NULL;
+static int scratch_scope_depth = 0;
+
+static jsmbed_wrap_scratch_stats_t scratch_stats = { 0, 0, 0, 0 };
+
+static bool is_in_arena(void *ptr)
+{
+  uint8_t *arena_start = (uint8_t*) scratch_arena;
+  return ((uint8_t*) ptr >= arena_start && (uint8_t*) ptr < arena_start + sizeof(scratch_arena));
+}
+
+void *jsmbed_wrap_scratch_alloc(size_t size)
+{
+  size_t aligned_size = (size + scratch_alignment - 1) & ~(scratch_alignment - 1);
+
+  scratch_stats.allocations++;
+
+  if (scratch_scope_depth > 0 && aligned_size <= sizeof(scratch_arena) - scratch_offset)
+  {
+    void *ptr = (uint8_t*) scratch_arena + scratch_offset;
+    scratch_offset += aligned_size;
+    if (scratch_offset > scratch_stats.high_water_mark)
+    {
+      scratch_stats.high_water_mark = scratch_offset;
+    }
+    return ptr;
+  }
+
+  scratch_stats.heap_fallbacks++;
+  scratch_stats.heap_fallback_bytes += size;
+  LOG_PRINT("[SCRATCH] HEAP-FALLBACK %d bytes (depth %d)\n", size, scratch_scope_depth);
+
+  fallback_header *header = (fallback_header*) malloc(fallback_header_size + size);
+  if (header == NULL)
+  {
+    return NULL;
+  }
+
+  if (scratch_scope_depth > 0)
+  {
+    header->scoped = 1;
+    header->next = scratch_fallbacks;
+    scratch_fallbacks = header;
+  }
+  else
+  {
+    header->scoped = 0;
+    header->next = NULL;
+  }
+
+  return (uint8_t*) header + fallback_header_size;
+}
+
+void jsmbed_wrap_scratch_free(void *ptr)
+{
+  if (ptr == NULL || is_in_arena(ptr))
+  {
+    return;
+  }
+
+  // Fallbacks made inside a binding are left for the scope to release,
+  // unlinking them here would break the chain for any enclosing scopes.
+  fallback_header *header = (fallback_header*) ((uint8_t*) ptr - fallback_header_size);
+  if (!header->scoped)
+  {
+    free(header);
+  }
+}
+
+void jsmbed_wrap_scratch_get_stats(jsmbed_wrap_scratch_stats_t *stats)
+{
+  *stats = scratch_stats;
+}
+
+JSScratchArenaScope::JSScratchArenaScope() :
+  saved_offset(scratch_offset),
+  saved_fallbacks(scratch_fallbacks)
+{
+  scratch_scope_depth++;
+}
+
+JSScratchArenaScope::~JSScratchArenaScope()
+{
+  while (scratch_fallbacks != saved_fallbacks)
+  {
+    fallback_header *next = scratch_fallbacks->next;
+    free(scratch_fallbacks);
+    scratch_fallbacks = next;
+  }
+
+  scratch_offset = saved_offset;
+  scratch_scope_depth--;
+}
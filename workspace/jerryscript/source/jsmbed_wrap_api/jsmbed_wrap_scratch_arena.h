@@ -0,0 +1,78 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JSMBED_WRAP_SCRATCH_ARENA_H__
+#define __JSMBED_WRAP_SCRATCH_ARENA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Size of the static buffer that binding temporaries are bump-allocated
+ * from. Requests that don't fit fall back to the heap.
+ */
+#ifndef JSMBED_SCRATCH_ARENA_SIZE
+#  define JSMBED_SCRATCH_ARENA_SIZE 512
+#endif
+
+typedef struct {
+  uint32_t allocations;       // Total number of scratch allocations.
+  uint32_t heap_fallbacks;    // How many of those had to go to the heap.
+  uint32_t heap_fallback_bytes;
+  uint32_t high_water_mark;   // Most of the arena ever in use at once.
+} jsmbed_wrap_scratch_stats_t;
+
+/*
+ * Allocates temporary memory for use while a binding is running.
+ *
+ * Inside a binding (i.e. anything declared with DECLARE_GLOBAL_FUNCTION,
+ * DECLARE_CLASS_CONSTRUCTOR or DECLARE_CLASS_FUNCTION), everything
+ * allocated here is released automatically when the binding returns,
+ * including heap fallbacks. Outside of a binding the memory always comes
+ * from the heap, and must be released with jsmbed_wrap_scratch_free.
+ *
+ * Returns NULL only if the heap is exhausted.
+ */
+void *jsmbed_wrap_scratch_alloc(size_t size);
+
+/*
+ * Releases scratch memory early. This is only required for memory that
+ * was allocated outside of a binding, but is always safe to call.
+ */
+void jsmbed_wrap_scratch_free(void *ptr);
+
+void jsmbed_wrap_scratch_get_stats(jsmbed_wrap_scratch_stats_t *stats);
+
+/*
+ * Marks the start of a binding call. Everything allocated from the scratch
+ * arena while this is alive is released when it goes out of scope. Scopes
+ * nest, so a binding that calls back into JavaScript which calls another
+ * binding only releases what the inner binding allocated.
+ *
+ * The DECLARE_*_FUNCTION macros create one of these for every binding, so
+ * there should be no need to use it directly.
+ */
+class JSScratchArenaScope
+{
+public:
+  JSScratchArenaScope();
+  ~JSScratchArenaScope();
+
+private:
+  size_t saved_offset;
+  void *saved_fallbacks;
+};
+
+#endif
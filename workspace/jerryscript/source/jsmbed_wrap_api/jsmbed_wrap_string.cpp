@@ -0,0 +1,54 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "jsmbed_wrap_string.h"
+
+char *jsmbed_wrap_string_to_buffer(const jerry_string_t *js_string, char *buffer, size_t buffer_size, size_t *size_p)
+{
+  jerry_size_t string_size = jerry_get_string_size(js_string);
+  *size_p = string_size;
+
+  char *data = buffer;
+  if (string_size + 1 > buffer_size)
+  {
+    data = (char*) jsmbed_wrap_scratch_alloc(string_size + 1);
+    if (data == NULL)
+    {
+      return NULL;
+    }
+  }
+
+  jerry_string_to_char_buffer(js_string, (jerry_char_t*) data, string_size);
+  data[string_size] = '\0';
+  return data;
+}
+
+bool jsmbed_wrap_string_equals(const jerry_string_t *js_string, const char *native_string, size_t native_size)
+{
+  // Most mismatches differ in size, which doesn't need a copy to find out.
+  if (jerry_get_string_size(js_string) != native_size)
+  {
+    return false;
+  }
+
+  JSStackString<> js_native_string(js_string);
+  if (js_native_string.c_str() == NULL)
+  {
+    return false;
+  }
+  return memcmp(js_native_string.c_str(), native_string, native_size) == 0;
+}
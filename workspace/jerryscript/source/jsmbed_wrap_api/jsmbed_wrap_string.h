@@ -0,0 +1,94 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JSMBED_WRAP_STRING_H__
+#define __JSMBED_WRAP_STRING_H__
+
+#include <stddef.h>
+#include <string.h>
+
+#include "jerry-core/jerry.h"
+
+#include "jsmbed_wrap_scratch_arena.h"
+
+/*
+ * Strings up to this many bytes (excluding the terminator) are converted on
+ * the stack by JSStackString and compared on the stack by
+ * jsmbed_wrap_string_equals. Longer strings spill into the scratch arena.
+ */
+#ifndef JSMBED_STRING_INLINE_SIZE
+#  define JSMBED_STRING_INLINE_SIZE 32
+#endif
+
+/*
+ * Copies a JS string into BUFFER as a NUL-terminated UTF-8 string if it fits
+ * (including the terminator), and otherwise into memory from the scratch
+ * arena. Returns the string, which is BUFFER unless it spilled, or NULL if
+ * it spilled and the heap is exhausted. SIZE_P is set to its size in bytes.
+ *
+ * A spilled string should be released with jsmbed_wrap_scratch_free, although
+ * inside a binding that happens anyway when the binding returns.
+ */
+char *jsmbed_wrap_string_to_buffer(const jerry_string_t *js_string, char *buffer, size_t buffer_size, size_t *size_p);
+
+// Compares a JS string with a native one without allocating from the heap.
+bool jsmbed_wrap_string_equals(const jerry_string_t *js_string, const char *native_string, size_t native_size);
+
+inline bool jsmbed_wrap_string_equals(const jerry_string_t *js_string, const char *native_string)
+{
+  return jsmbed_wrap_string_equals(js_string, native_string, strlen(native_string));
+}
+
+/*
+ * A JS string converted to a native one, on the stack when it is no longer
+ * than N bytes, and released automatically when it goes out of scope. For
+ * example:
+ *
+ * JSStackString<> command(jsmbed_wrap_unbox_string(&args_p[0]));
+ * if (command.c_str() != NULL && strcmp(command.c_str(), "reset") == 0) { ... }
+ */
+template<size_t N = JSMBED_STRING_INLINE_SIZE>
+class JSStackString
+{
+public:
+  explicit JSStackString(const jerry_string_t *js_string)
+  {
+    data = jsmbed_wrap_string_to_buffer(js_string, storage, sizeof(storage), &size);
+  }
+
+  ~JSStackString()
+  {
+    if (data != storage)
+    {
+      jsmbed_wrap_scratch_free(data);
+    }
+  }
+
+  // NULL only if the string spilled and the heap is exhausted.
+  const char *c_str() const { return data; }
+  size_t get_size() const { return size; }
+  bool is_on_stack() const { return data == storage; }
+
+private:
+  // Not copyable, since data may point into storage.
+  JSStackString(const JSStackString &);
+  JSStackString &operator=(const JSStackString &);
+
+  char storage[N + 1];
+  char *data;
+  size_t size;
+};
+
+#endif
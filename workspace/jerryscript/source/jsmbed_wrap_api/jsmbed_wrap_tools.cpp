@@ -16,12 +16,21 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "jsmbed_wrap_tools.h"
 
 bool
 jsmbed_wrap_register_global_function (const char* name,
                           jerry_external_handler_t handler)
+{
+  return jsmbed_wrap_register_global_function_sz((const jerry_char_t *) name, strlen(name), handler);
+}
+
+bool
+jsmbed_wrap_register_global_function_sz (const jerry_char_t* name,
+                          jerry_size_t name_size,
+                          jerry_external_handler_t handler)
 {
   jerry_object_t *global_obj_p;
   jerry_object_t *reg_func_p;
@@ -35,7 +44,7 @@ jsmbed_wrap_register_global_function (const char* name,
       && jerry_is_function (reg_func_p)
       && jerry_is_constructor (reg_func_p)))
   {
-    printf ("Error: register_global_function failed: [%s]\r\n", name);
+    printf ("Error: register_global_function failed: [%.*s]\r\n", (int) name_size, name);
     jerry_release_object (global_obj_p);
     return false;
   }
@@ -44,8 +53,9 @@ jsmbed_wrap_register_global_function (const char* name,
   reg_value.type = JERRY_DATA_TYPE_OBJECT;
   reg_value.u.v_object = reg_func_p;
 
-  bok = jerry_set_object_field_value (global_obj_p,
-                                          (jerry_char_t *) name,
+  bok = jerry_set_object_field_value_sz (global_obj_p,
+                                          name,
+                                          name_size,
                                           &reg_value);
 
   jerry_release_value (&reg_value);
@@ -54,7 +64,7 @@ jsmbed_wrap_register_global_function (const char* name,
 
   if (!bok)
   {
-    printf ("Error: register_global_function failed: [%s]\r\n", name);
+    printf ("Error: register_global_function failed: [%.*s]\r\n", (int) name_size, name);
   }
 
   return bok;
@@ -72,6 +82,15 @@ bool
 jsmbed_wrap_register_class_function (jerry_object_t* this_obj_p,
                          const char* name,
                          jerry_external_handler_t handler)
+{
+  return jsmbed_wrap_register_class_function_sz(this_obj_p, (const jerry_char_t *) name, strlen(name), handler);
+}
+
+bool
+jsmbed_wrap_register_class_function_sz (jerry_object_t* this_obj_p,
+                         const jerry_char_t* name,
+                         jerry_size_t name_size,
+                         jerry_external_handler_t handler)
 {
   jerry_object_t *reg_func_p;
   jerry_value_t reg_value;
@@ -91,8 +110,9 @@ jsmbed_wrap_register_class_function (jerry_object_t* this_obj_p,
   reg_value.type = JERRY_DATA_TYPE_OBJECT;
   reg_value.u.v_object = reg_func_p;
 
-  bok = jerry_set_object_field_value (this_obj_p,
-                                          (jerry_char_t *) name,
+  bok = jerry_set_object_field_value_sz (this_obj_p,
+                                          name,
+                                          name_size,
                                           &reg_value);
 
   jerry_release_value (&reg_value);
@@ -100,8 +120,42 @@ jsmbed_wrap_register_class_function (jerry_object_t* this_obj_p,
 
   if (!bok)
   {
-    printf ("Error: register_class_function failed: [%s]\r\n", name);
+    printf ("Error: register_class_function failed: [%.*s]\r\n", (int) name_size, name);
   }
 
   return bok;
 }
+
+//
+// Native object links
+//
+// The free callback for objects linked with jsmbed_wrap_link_typed_objects.
+static void jsmbed_wrap_free_typed_link(const uintptr_t handle)
+{
+  jsmbed_wrap_native_link_t *link = (jsmbed_wrap_native_link_t*) (handle & ~JSMBED_WRAP_TYPED_LINK);
+  // The link goes with the native object, so nothing is read after this.
+  link->free_function(link->native_obj);
+}
+
+void jsmbed_wrap_link_typed_objects(jerry_object_t *js_obj, jsmbed_wrap_native_link_t *link,
+                                    uintptr_t native_obj, jsmbed_wrap_free_function_t free_function)
+{
+  link->native_obj = native_obj;
+  link->free_function = free_function;
+  jerry_set_object_native_handle(js_obj, (uintptr_t) link | JSMBED_WRAP_TYPED_LINK, jsmbed_wrap_free_typed_link);
+}
+
+uintptr_t jsmbed_wrap_get_native_handle_of_type(const jerry_value_t *val_p, jsmbed_wrap_free_function_t free_function)
+{
+  uintptr_t handle;
+  if (!jsmbed_wrap_value_is_object(val_p) ||
+      !jerry_get_object_native_handle(val_p->u.v_object, &handle) ||
+      (handle & JSMBED_WRAP_TYPED_LINK) == 0)
+  {
+    // Not natively backed, or linked without a link to check.
+    return 0;
+  }
+
+  jsmbed_wrap_native_link_t *link = (jsmbed_wrap_native_link_t*) (handle & ~JSMBED_WRAP_TYPED_LINK);
+  return (link->free_function == free_function) ? link->native_obj : 0;
+}
@@ -21,7 +21,14 @@
 
 #include "jerry-core/jerry.h"
 
+#include "jsmbed_wrap_keys.h"
 #include "jsmbed_wrap_name_macros.h"
+#include "jsmbed_wrap_native_link.h"
+#include "jsmbed_wrap_overload.h"
+#include "jsmbed_wrap_profile.h"
+#include "jsmbed_wrap_schema.h"
+#include "jsmbed_wrap_scratch_arena.h"
+#include "jsmbed_wrap_string.h"
 
 //
 // 1. Wrapper registration macros
@@ -38,41 +45,49 @@
 // 2. Wrapper function declaration/use macros
 //
 
-// Global functions
-#define DECLARE_GLOBAL_FUNCTION(NAME) \
-bool \
-NAME_FOR_GLOBAL_FUNCTION(NAME) (const jerry_object_t * function_obj_p, \
+// Each of the DECLARE_ macros below generates a trampoline, which is the
+// function that is actually registered with jerryscript, followed by the
+// signature of the body that the macro is used to define. The trampoline
+// opens a scratch arena scope, so that anything the body allocates with
+// jsmbed_wrap_scratch_alloc is released once it returns, and when
+// JSMBED_PROFILE_BINDINGS is defined, counts and times the call.
+#define JSMBED_WRAP_HANDLER_PARAMS \
+                  const jerry_object_t * function_obj_p, \
                   const jerry_value_t *  this_p, \
                   jerry_value_t *        ret_val_p, \
                   const jerry_value_t    args_p[], \
-                  const jerry_length_t   args_count)
+                  const jerry_length_t   args_count
+
+#define DECLARE_TRAMPOLINE(TRAMPOLINE, BODY, CLASS_NAME, NAME) \
+static bool BODY (JSMBED_WRAP_HANDLER_PARAMS); \
+bool TRAMPOLINE (JSMBED_WRAP_HANDLER_PARAMS) \
+{ \
+  JSMBED_WRAP_PROFILE_SCOPE(CLASS_NAME, NAME); \
+  JSScratchArenaScope scratch_scope; \
+  return BODY (function_obj_p, this_p, ret_val_p, args_p, args_count); \
+} \
+static bool BODY (JSMBED_WRAP_HANDLER_PARAMS)
+
+// Global functions
+#define DECLARE_GLOBAL_FUNCTION(NAME) \
+  DECLARE_TRAMPOLINE(NAME_FOR_GLOBAL_FUNCTION(NAME), NAME_FOR_GLOBAL_FUNCTION_BODY(NAME), "global", # NAME)
 
 #define REGISTER_GLOBAL_FUNCTION(NAME) \
-  jsmbed_wrap_register_global_function ( # NAME, NAME_FOR_GLOBAL_FUNCTION(NAME) )
+  jsmbed_wrap_register_global_function_sz ( JSMBED_WRAP_SZ(# NAME), NAME_FOR_GLOBAL_FUNCTION(NAME) )
 
 // Class constructors
 #define DECLARE_CLASS_CONSTRUCTOR(CLASS) \
-bool \
-NAME_FOR_CLASS_CONSTRUCTOR(CLASS) (const jerry_object_t * function_obj_p, \
-                  const jerry_value_t *  this_p, \
-                  jerry_value_t *        ret_val_p, \
-                  const jerry_value_t    args_p[], \
-                  const jerry_length_t   args_count)
+  DECLARE_TRAMPOLINE(NAME_FOR_CLASS_CONSTRUCTOR(CLASS), NAME_FOR_CLASS_CONSTRUCTOR_BODY(CLASS), # CLASS, "constructor")
 
 #define REGISTER_CLASS_CONSTRUCTOR(CLASS) \
-  jsmbed_wrap_register_class_constructor ( # CLASS, NAME_FOR_CLASS_CONSTRUCTOR(CLASS) )
+  jsmbed_wrap_register_global_function_sz ( JSMBED_WRAP_SZ(# CLASS), NAME_FOR_CLASS_CONSTRUCTOR(CLASS) )
 
 // Class functions
 #define DECLARE_CLASS_FUNCTION(CLASS, NAME) \
-bool \
-NAME_FOR_CLASS_FUNCTION(CLASS, NAME) (const jerry_object_t * function_obj_p, \
-                  const jerry_value_t *  this_p, \
-                  jerry_value_t *        ret_val_p, \
-                  const jerry_value_t    args_p[], \
-                  const jerry_length_t   args_count)
+  DECLARE_TRAMPOLINE(NAME_FOR_CLASS_FUNCTION(CLASS, NAME), NAME_FOR_CLASS_FUNCTION_BODY(CLASS, NAME), # CLASS, # NAME)
 
 #define ATTACH_CLASS_FUNCTION(OBJECT, CLASS, NAME) \
-  jsmbed_wrap_register_class_function (OBJECT, # NAME, NAME_FOR_CLASS_FUNCTION(CLASS, NAME) )
+  jsmbed_wrap_register_class_function_sz (OBJECT, JSMBED_WRAP_SZ(# NAME), NAME_FOR_CLASS_FUNCTION(CLASS, NAME) )
 
 //
 // 3. Argument checking macros
@@ -232,11 +247,44 @@ inline jerry_object_t *jsmbed_wrap_create_object()
   return jerry_create_object();
 }
 
-inline void jsmbed_wrap_link_objects(jerry_object_t *js_obj, uintptr_t native_obj, void (*free_function)(uintptr_t))
+// For bindings that take an optional result object to fill in place: returns
+// the object passed as argument INDEX, or a new one if there isn't one. Either
+// way the binding owns a reference, which is usually handed to ret_val_p.
+inline jerry_object_t *jsmbed_wrap_result_object(const jerry_value_t args_p[], jerry_length_t args_count, jerry_length_t index)
+{
+  if (index < args_count && jsmbed_wrap_value_is_object(&args_p[index]))
+  {
+    jerry_object_t *obj_p = jsmbed_wrap_unbox_object(&args_p[index]);
+    jsmbed_wrap_acquire_object(obj_p);
+    return obj_p;
+  }
+  return jsmbed_wrap_create_object();
+}
+
+// Set in the native handle of objects linked with
+// jsmbed_wrap_link_typed_objects, whose handle is their link rather than the
+// native object. Links and native objects are pointer aligned, so the bit is
+// otherwise always clear.
+#define JSMBED_WRAP_TYPED_LINK 1
+
+/*
+ * Most JS objects point straight at their native object, so linking them
+ * allocates nothing, and a method call gets the handle back in one step.
+ */
+inline void jsmbed_wrap_link_objects(jerry_object_t *js_obj, uintptr_t native_obj, jsmbed_wrap_free_function_t free_function)
 {
   jerry_set_object_native_handle(js_obj, native_obj, (jerry_object_free_callback_t) free_function);
 }
 
+/*
+ * Links a JS object to a native object of a type that bindings need to
+ * recognise when they're passed one, through a link that is part of the
+ * native object (so it is freed along with it). Only objects linked this
+ * way are found by jsmbed_wrap_get_native_handle_of_type.
+ */
+void jsmbed_wrap_link_typed_objects(jerry_object_t *js_obj, jsmbed_wrap_native_link_t *link,
+                                    uintptr_t native_obj, jsmbed_wrap_free_function_t free_function);
+
 inline uintptr_t jsmbed_wrap_get_native_handle(const jerry_value_t *val_p)
 {
   uintptr_t handle;
@@ -250,9 +298,17 @@ inline uintptr_t jsmbed_wrap_get_native_handle(const jerry_value_t *val_p)
     printf("ERROR: Failed to get handle from supposedly natively-mapped object.\n");
     return 0;
   }
+  if (handle & JSMBED_WRAP_TYPED_LINK)
+  {
+    return ((jsmbed_wrap_native_link_t*) (handle & ~JSMBED_WRAP_TYPED_LINK))->native_obj;
+  }
   return handle;
 }
 
+// Returns 0, without printing anything, unless val_p is an object that was
+// linked with jsmbed_wrap_link_typed_objects and free_function.
+uintptr_t jsmbed_wrap_get_native_handle_of_type(const jerry_value_t *val_p, jsmbed_wrap_free_function_t free_function);
+
 inline void jsmbed_wrap_box_undefined(jerry_value_t *val_p)
 {
   val_p->type = JERRY_DATA_TYPE_UNDEFINED;
@@ -277,13 +333,23 @@ inline void jsmbed_wrap_box_boolean(jerry_value_t *val_p, bool v)
   val_p->type = JERRY_DATA_TYPE_BOOLEAN;
   val_p->u.v_bool = v;
 }
+inline void jsmbed_wrap_box_number(jerry_value_t *val_p, double v)
+{
+  val_p->type = JERRY_DATA_TYPE_FLOAT64;
+  val_p->u.v_float64 = v;
+}
 
 inline int jsmbed_wrap_get_array_length(const jerry_value_t *val_p)
 {
   jerry_object_t *data_array = jsmbed_wrap_unbox_object(val_p);
   jerry_value_t length_value;
-  jerry_get_object_field_value(data_array, (const unsigned char*) "length", &length_value);
-  return jsmbed_wrap_unbox_number(&length_value);
+  if (!jsmbed_wrap_get_field(data_array, JS_KEY(length), &length_value))
+  {
+    return 0;
+  }
+  int length = jsmbed_wrap_value_is_number(&length_value) ? jsmbed_wrap_unbox_number(&length_value) : 0;
+  jerry_release_value(&length_value);
+  return length;
 }
 
 // NB: Delete the char array when you're done with it!
@@ -294,6 +360,15 @@ inline char* jsmbed_wrap_alloc_same_sized_char_array(const jerry_value_t *val_p)
   return data;
 }
 
+// As above, but from the scratch arena. Release it with
+// jsmbed_wrap_scratch_free (never free()); inside a binding that is optional.
+inline char* jsmbed_wrap_scratch_alloc_same_sized_char_array(const jerry_value_t *val_p)
+{
+  int array_length = jsmbed_wrap_get_array_length(val_p);
+  char *data = (char*) jsmbed_wrap_scratch_alloc(sizeof(char) * array_length);
+  return data;
+}
+
 inline void jsmbed_wrap_copy_char_array_to_js_array(jerry_value_t *js_array, char *array)
 {
   jerry_value_t out_value;
@@ -325,6 +400,9 @@ inline void jsmbed_wrap_delete_char_array(char *array)
   free(array);
 }
 
+// NB: Free the string when you're done with it! JSStackString (see
+// jsmbed_wrap_string.h) avoids the allocation altogether for short strings,
+// and releases itself.
 inline char* jsmbed_wrap_alloc_and_copy_string_from_js_string(jerry_string_t *js_string)
 {
   jerry_size_t string_size = jerry_get_string_size(js_string);
@@ -333,6 +411,21 @@ inline char* jsmbed_wrap_alloc_and_copy_string_from_js_string(jerry_string_t *js
   return char_buffer;
 }
 
+// As above, but from the scratch arena. Release it with
+// jsmbed_wrap_scratch_free (never free()); inside a binding that is optional.
+inline char* jsmbed_wrap_scratch_copy_string_from_js_string(jerry_string_t *js_string)
+{
+  jerry_size_t string_size = jerry_get_string_size(js_string);
+  char *char_buffer = (char*) jsmbed_wrap_scratch_alloc(string_size + 1);
+  if (char_buffer == NULL)
+  {
+    return NULL;
+  }
+  char_buffer[string_size] = '\0';
+  jerry_string_to_char_buffer(js_string, (jerry_char_t*) char_buffer, string_size);
+  return char_buffer;
+}
+
 inline jerry_string_t *jsmbed_wrap_create_string(const char* native_string)
 {
   return jerry_create_string((const jerry_char_t *) native_string);
@@ -352,6 +445,11 @@ bool
 jsmbed_wrap_register_global_function (const char* name,
                           jerry_external_handler_t handler);
 
+bool
+jsmbed_wrap_register_global_function_sz (const jerry_char_t* name,
+                          jerry_size_t name_size,
+                          jerry_external_handler_t handler);
+
 bool
 jsmbed_wrap_register_class_constructor (const char* name,
                             jerry_external_handler_t handler);
@@ -361,4 +459,10 @@ jsmbed_wrap_register_class_function (jerry_object_t* this_obj_p,
                          const char* name,
                          jerry_external_handler_t handler);
 
+bool
+jsmbed_wrap_register_class_function_sz (jerry_object_t* this_obj_p,
+                         const jerry_char_t* name,
+                         jerry_size_t name_size,
+                         jerry_external_handler_t handler);
+
 #endif
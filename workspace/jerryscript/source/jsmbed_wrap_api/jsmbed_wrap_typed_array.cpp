@@ -0,0 +1,364 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "jsmbed_wrap_external_memory.h"
+#include "jsmbed_wrap_log_macros.h"
+#include "jsmbed_wrap_tools.h"
+
+#include "jsmbed_wrap_typed_array.h"
+
+// Same wrapping behaviour as ToInt32 in the spec, so that e.g. 256 stored
+// in a Uint8Array becomes 0 rather than being undefined behaviour.
+static int32_t to_int32(double value)
+{
+  if (isnan(value) || isinf(value))
+  {
+    return 0;
+  }
+  double wrapped = fmod(trunc(value), 4294967296.0);
+  if (wrapped < 0)
+  {
+    wrapped += 4294967296.0;
+  }
+  return (int32_t) (uint32_t) wrapped;
+}
+
+template<typename T>
+static void fill_elements(T *elements, T value, uint32_t begin, uint32_t end)
+{
+  for (uint32_t index = begin; index < end; index++)
+  {
+    elements[index] = value;
+  }
+}
+
+template<typename T>
+static double sum_elements(const T *elements, uint32_t length)
+{
+  double total = 0;
+  for (uint32_t index = 0; index < length; index++)
+  {
+    total += elements[index];
+  }
+  return total;
+}
+
+template<typename T>
+static double min_element(const T *elements, uint32_t length)
+{
+  T result = elements[0];
+  for (uint32_t index = 1; index < length; index++)
+  {
+    if (elements[index] < result)
+    {
+      result = elements[index];
+    }
+  }
+  return result;
+}
+
+template<typename T>
+static double max_element(const T *elements, uint32_t length)
+{
+  T result = elements[0];
+  for (uint32_t index = 1; index < length; index++)
+  {
+    if (elements[index] > result)
+    {
+      result = elements[index];
+    }
+  }
+  return result;
+}
+
+JSTypedArray::JSTypedArray(TypedArrayType type, uint32_t length) :
+  type(type),
+  length(length),
+  storage(NULL),
+  data(NULL)
+{
+  jsmbed_wrap_external_memory_add(sizeof(JSTypedArray));
+
+  if (length > max_length(type))
+  {
+    // Bindings should have checked, but the byte length must never wrap.
+    LOG_PRINT_ALWAYS("ERROR: Typed array of %u elements is too large.\n", length);
+    this->length = 0;
+    return;
+  }
+
+  // Storage is allocated as one block: the header, followed by the elements.
+  // The header is 8 bytes, so the elements are suitably aligned for any type.
+  uint32_t byte_length = get_byte_length();
+  jsmbed_wrap_external_memory_add(sizeof(storage_header) + byte_length);
+  storage = (storage_header*) calloc(1, sizeof(storage_header) + byte_length);
+
+  if (storage == NULL)
+  {
+    LOG_PRINT_ALWAYS("ERROR: Failed to allocate %d bytes for typed array.\n", byte_length);
+    jsmbed_wrap_external_memory_remove(sizeof(storage_header) + byte_length);
+    this->length = 0;
+    return;
+  }
+
+  storage->ref_count = 1;
+  storage->size = sizeof(storage_header) + byte_length;
+  data = (void*) (storage + 1);
+  LOG_PRINT("[TYPED ARRAY] CONSTRUCTOR 0x%x - %d %d\n", this, type, length);
+}
+
+JSTypedArray::JSTypedArray(JSTypedArray *parent, uint32_t begin, uint32_t end) :
+  type(parent->type),
+  length(0),
+  storage(parent->storage),
+  data(parent->data)
+{
+  jsmbed_wrap_external_memory_add(sizeof(JSTypedArray));
+
+  if (end > parent->length)
+  {
+    end = parent->length;
+  }
+  if (begin > end)
+  {
+    begin = end;
+  }
+
+  length = end - begin;
+  data = (void*) ((uint8_t*) parent->data + begin * get_element_size());
+
+  if (storage != NULL)
+  {
+    storage->ref_count++;
+  }
+  LOG_PRINT("[TYPED ARRAY] SUBARRAY 0x%x of 0x%x - %d %d\n", this, parent, begin, end);
+}
+
+JSTypedArray::~JSTypedArray()
+{
+  LOG_PRINT("[TYPED ARRAY] DESTRUCTOR 0x%x\n", this);
+  if (storage != NULL && --storage->ref_count == 0)
+  {
+    jsmbed_wrap_external_memory_remove(storage->size);
+    free(storage);
+  }
+  jsmbed_wrap_external_memory_remove(sizeof(JSTypedArray));
+}
+
+uint32_t JSTypedArray::element_size(TypedArrayType type)
+{
+  switch (type)
+  {
+    case TYPED_ARRAY_UINT8:
+      return sizeof(uint8_t);
+    case TYPED_ARRAY_INT16:
+      return sizeof(int16_t);
+    case TYPED_ARRAY_UINT16:
+      return sizeof(uint16_t);
+    case TYPED_ARRAY_INT32:
+      return sizeof(int32_t);
+    case TYPED_ARRAY_FLOAT32:
+      return sizeof(float);
+  }
+  return 0;
+}
+
+double JSTypedArray::get(uint32_t index) const
+{
+  switch (type)
+  {
+    case TYPED_ARRAY_UINT8:
+      return ((uint8_t*) data)[index];
+    case TYPED_ARRAY_INT16:
+      return ((int16_t*) data)[index];
+    case TYPED_ARRAY_UINT16:
+      return ((uint16_t*) data)[index];
+    case TYPED_ARRAY_INT32:
+      return ((int32_t*) data)[index];
+    case TYPED_ARRAY_FLOAT32:
+      return ((float*) data)[index];
+  }
+  return 0;
+}
+
+void JSTypedArray::set(uint32_t index, double value)
+{
+  switch (type)
+  {
+    case TYPED_ARRAY_UINT8:
+      ((uint8_t*) data)[index] = (uint8_t) to_int32(value);
+      break;
+    case TYPED_ARRAY_INT16:
+      ((int16_t*) data)[index] = (int16_t) to_int32(value);
+      break;
+    case TYPED_ARRAY_UINT16:
+      ((uint16_t*) data)[index] = (uint16_t) to_int32(value);
+      break;
+    case TYPED_ARRAY_INT32:
+      ((int32_t*) data)[index] = to_int32(value);
+      break;
+    case TYPED_ARRAY_FLOAT32:
+      ((float*) data)[index] = (float) value;
+      break;
+  }
+}
+
+void JSTypedArray::fill(double value, uint32_t begin, uint32_t end)
+{
+  if (end > length)
+  {
+    end = length;
+  }
+  if (begin >= end)
+  {
+    return;
+  }
+
+  switch (type)
+  {
+    case TYPED_ARRAY_UINT8:
+      // Single byte elements can use the (usually much faster) libc fill.
+      memset((uint8_t*) data + begin, (uint8_t) to_int32(value), end - begin);
+      break;
+    case TYPED_ARRAY_INT16:
+      fill_elements((int16_t*) data, (int16_t) to_int32(value), begin, end);
+      break;
+    case TYPED_ARRAY_UINT16:
+      fill_elements((uint16_t*) data, (uint16_t) to_int32(value), begin, end);
+      break;
+    case TYPED_ARRAY_INT32:
+      fill_elements((int32_t*) data, to_int32(value), begin, end);
+      break;
+    case TYPED_ARRAY_FLOAT32:
+      fill_elements((float*) data, (float) value, begin, end);
+      break;
+  }
+}
+
+void JSTypedArray::copy_within(uint32_t target, uint32_t begin, uint32_t end)
+{
+  if (end > length)
+  {
+    end = length;
+  }
+  if (begin >= end || target >= length)
+  {
+    return;
+  }
+
+  uint32_t count = end - begin;
+  if (count > length - target)
+  {
+    count = length - target;
+  }
+
+  uint32_t element_size = get_element_size();
+  memmove((uint8_t*) data + target * element_size,
+      (uint8_t*) data + begin * element_size,
+      count * element_size);
+}
+
+double JSTypedArray::sum() const
+{
+  switch (type)
+  {
+    case TYPED_ARRAY_UINT8:
+      return sum_elements((uint8_t*) data, length);
+    case TYPED_ARRAY_INT16:
+      return sum_elements((int16_t*) data, length);
+    case TYPED_ARRAY_UINT16:
+      return sum_elements((uint16_t*) data, length);
+    case TYPED_ARRAY_INT32:
+      return sum_elements((int32_t*) data, length);
+    case TYPED_ARRAY_FLOAT32:
+      return sum_elements((float*) data, length);
+  }
+  return 0;
+}
+
+double JSTypedArray::min() const
+{
+  if (length == 0)
+  {
+    return NAN;
+  }
+
+  switch (type)
+  {
+    case TYPED_ARRAY_UINT8:
+      return min_element((uint8_t*) data, length);
+    case TYPED_ARRAY_INT16:
+      return min_element((int16_t*) data, length);
+    case TYPED_ARRAY_UINT16:
+      return min_element((uint16_t*) data, length);
+    case TYPED_ARRAY_INT32:
+      return min_element((int32_t*) data, length);
+    case TYPED_ARRAY_FLOAT32:
+      return min_element((float*) data, length);
+  }
+  return NAN;
+}
+
+double JSTypedArray::max() const
+{
+  if (length == 0)
+  {
+    return NAN;
+  }
+
+  switch (type)
+  {
+    case TYPED_ARRAY_UINT8:
+      return max_element((uint8_t*) data, length);
+    case TYPED_ARRAY_INT16:
+      return max_element((int16_t*) data, length);
+    case TYPED_ARRAY_UINT16:
+      return max_element((uint16_t*) data, length);
+    case TYPED_ARRAY_INT32:
+      return max_element((int32_t*) data, length);
+    case TYPED_ARRAY_FLOAT32:
+      return max_element((float*) data, length);
+  }
+  return NAN;
+}
+
+double JSTypedArray::mean() const
+{
+  if (length == 0)
+  {
+    return NAN;
+  }
+  return sum() / length;
+}
+
+static void jsmbed_wrap_free_typed_array(uintptr_t handle)
+{
+  LOG_PRINT("[TYPED ARRAY] FREE 0x%x\n", handle);
+  delete (JSTypedArray*) handle;
+}
+
+void jsmbed_wrap_link_typed_array(jerry_object_t *js_obj, JSTypedArray *typed_array)
+{
+  jsmbed_wrap_link_typed_objects(js_obj, typed_array->get_link(), (uintptr_t) typed_array, jsmbed_wrap_free_typed_array);
+}
+
+JSTypedArray *jsmbed_wrap_get_typed_array(const jerry_value_t *val_p)
+{
+  return (JSTypedArray*) jsmbed_wrap_get_native_handle_of_type(val_p, jsmbed_wrap_free_typed_array);
+}
@@ -0,0 +1,114 @@
+/* Copyright (c) 2016 ARM Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JSMBED_WRAP_TYPED_ARRAY_H__
+#define __JSMBED_WRAP_TYPED_ARRAY_H__
+
+#include <stdint.h>
+
+#include "jerry-core/jerry.h"
+
+#include "jsmbed_wrap_native_link.h"
+
+// The largest typed array that can be created, in bytes.
+#ifndef JSMBED_TYPED_ARRAY_MAX_BYTES
+#  define JSMBED_TYPED_ARRAY_MAX_BYTES (64 * 1024)
+#endif
+
+enum TypedArrayType {
+  TYPED_ARRAY_UINT8,
+  TYPED_ARRAY_INT16,
+  TYPED_ARRAY_UINT16,
+  TYPED_ARRAY_INT32,
+  TYPED_ARRAY_FLOAT32
+};
+
+/*
+ * A fixed-length view of contiguous native memory, holding elements of
+ * a single numeric type.
+ *
+ * jerryscript has no TypedArray support, so this is what lets JavaScript
+ * keep sample windows compact (one native element per entry, rather than
+ * one boxed number per entry) and have bulk operations over them run in
+ * C++.
+ *
+ * Views created with subarray() share storage with the view they were
+ * created from. The storage is reference counted, and is freed when the
+ * last view onto it is destroyed.
+ */
+class JSTypedArray
+{
+public:
+  JSTypedArray(TypedArrayType type, uint32_t length);
+  JSTypedArray(JSTypedArray *parent, uint32_t begin, uint32_t end);
+  ~JSTypedArray();
+
+  TypedArrayType get_type() const { return type; }
+  uint32_t get_length() const { return length; }
+  uint32_t get_element_size() const { return element_size(type); }
+  uint32_t get_byte_length() const { return length * get_element_size(); }
+  void *get_data() const { return data; }
+
+  // Indices are not range checked here, callers must check against get_length().
+  double get(uint32_t index) const;
+  void set(uint32_t index, double value);
+
+  // Ranges are [begin, end), and are clamped to the length of the view.
+  void fill(double value, uint32_t begin, uint32_t end);
+  void copy_within(uint32_t target, uint32_t begin, uint32_t end);
+
+  double sum() const;
+  double min() const;
+  double max() const;
+  double mean() const;
+
+  jsmbed_wrap_native_link_t *get_link() { return &link; }
+
+  static uint32_t element_size(TypedArrayType type);
+  // The most elements a typed array of this type can have.
+  static uint32_t max_length(TypedArrayType type) { return JSMBED_TYPED_ARRAY_MAX_BYTES / element_size(type); }
+
+private:
+  struct storage_header {
+    uint32_t ref_count;
+    uint32_t size;  // Of the whole block, for external memory accounting.
+  };
+
+  TypedArrayType type;
+  uint32_t length;
+  storage_header *storage;
+  void *data;
+  jsmbed_wrap_native_link_t link;
+};
+
+/*
+ * Links a JS object to a typed array, which is deleted along with it. Only
+ * objects linked this way are recognised by jsmbed_wrap_get_typed_array.
+ */
+void jsmbed_wrap_link_typed_array(jerry_object_t *js_obj, JSTypedArray *typed_array);
+
+/*
+ * Returns the typed array behind a JS value, or NULL if the value is not a
+ * typed array. Peripheral bindings can use this to accept typed arrays and
+ * operate directly on their memory.
+ */
+JSTypedArray *jsmbed_wrap_get_typed_array(const jerry_value_t *val_p);
+
+inline bool jsmbed_wrap_value_is_typed_array(const jerry_value_t* val_p)
+{
+  return (jsmbed_wrap_get_typed_array(val_p) != NULL);
+}
+
+#endif
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <limits.h>
+#include <math.h>
+
 #include "mbed.h"
 #include "rtos.h"
 
@@ -22,130 +25,2488 @@
 #include "jsmbed_wrap_function_mailman.h"
 #include "jsmbed_wrap_log_macros.h"
 #include "jsmbed_wrap_name_macros.h"
+#include "jsmbed_wrap_object_pool.h"
+#include "jsmbed_wrap_typed_array.h"
 
 #include "pkgjsmbed_base_native.h"
 
+//
+// Native objects are allocated from fixed-size pools, so that creating and
+// destroying them repeatedly doesn't fragment the heap. The sizes can be
+// overridden for boards that need more (or fewer) of a given class; once a
+// pool is full, further objects come from the heap.
+//
+#ifndef JSMBED_POOL_SIZE_DIGITAL_OUT
+#  define JSMBED_POOL_SIZE_DIGITAL_OUT 8
+#endif
+#ifndef JSMBED_POOL_SIZE_BUS_OUT
+#  define JSMBED_POOL_SIZE_BUS_OUT 4
+#endif
+#ifndef JSMBED_POOL_SIZE_PORT_OUT
+#  define JSMBED_POOL_SIZE_PORT_OUT 4
+#endif
+#ifndef JSMBED_POOL_SIZE_DIGITAL_OUT_GROUP
+#  define JSMBED_POOL_SIZE_DIGITAL_OUT_GROUP 2
+#endif
+#ifndef JSMBED_POOL_SIZE_DIGITAL_IN
+#  define JSMBED_POOL_SIZE_DIGITAL_IN 8
+#endif
+#ifndef JSMBED_POOL_SIZE_BUS_IN
+#  define JSMBED_POOL_SIZE_BUS_IN 4
+#endif
+#ifndef JSMBED_POOL_SIZE_PORT_IN
+#  define JSMBED_POOL_SIZE_PORT_IN 4
+#endif
+#ifndef JSMBED_POOL_SIZE_I2C
+#  define JSMBED_POOL_SIZE_I2C 2
+#endif
+#ifndef JSMBED_POOL_SIZE_SPI
+#  define JSMBED_POOL_SIZE_SPI 2
+#endif
+#ifndef JSMBED_POOL_SIZE_SERIAL
+#  define JSMBED_POOL_SIZE_SERIAL 2
+#endif
+#ifndef JSMBED_POOL_SIZE_FRAMER
+#  define JSMBED_POOL_SIZE_FRAMER 2
+#endif
+#ifndef JSMBED_POOL_SIZE_ANALOG_IN
+#  define JSMBED_POOL_SIZE_ANALOG_IN 4
+#endif
+#ifndef JSMBED_POOL_SIZE_ANALOG_SAMPLER
+#  define JSMBED_POOL_SIZE_ANALOG_SAMPLER 2
+#endif
+#ifndef JSMBED_POOL_SIZE_PWM_OUT
+#  define JSMBED_POOL_SIZE_PWM_OUT 4
+#endif
+#ifndef JSMBED_POOL_SIZE_TICKER
+#  define JSMBED_POOL_SIZE_TICKER 4
+#endif
+#ifndef JSMBED_POOL_SIZE_INTERRUPT_IN
+#  define JSMBED_POOL_SIZE_INTERRUPT_IN 4
+#endif
+#ifndef JSMBED_POOL_SIZE_PULSE_IN
+#  define JSMBED_POOL_SIZE_PULSE_IN 2
+#endif
+
+static JSObjectPool<DigitalOut, JSMBED_POOL_SIZE_DIGITAL_OUT> digital_out_pool("DigitalOut");
+
 uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalOut, I_I) (int pin, int value)
 {
-  uintptr_t handle = (uintptr_t) new DigitalOut((PinName) pin, value);
+  uintptr_t handle = (uintptr_t) digital_out_pool.construct((PinName) pin, value);
+  if (handle == 0)
+  {
+    return 0;
+  }
   LOG_PRINT("[WRAPPER] CREATE DigitalOut 0x%x (0x%x) - %d %d\n", handle, *((uint32_t*)handle), pin, value);
   return handle;
 }
 
 uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalOut, I) (int pin)
 {
-  uintptr_t handle = (uintptr_t) new DigitalOut((PinName) pin);
+  uintptr_t handle = (uintptr_t) digital_out_pool.construct((PinName) pin);
+  if (handle == 0)
+  {
+    return 0;
+  }
   LOG_PRINT("[WRAPPER] CREATE DigitalOut 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pin);
   return handle;
 }
 
-void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(DigitalOut) (uintptr_t handle)
-{
-  LOG_PRINT("[WRAPPER] DESTROY DigitalOut 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
-  delete (DigitalOut*) handle;
-  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE DigitalOut\n");
-}
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(DigitalOut) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY DigitalOut 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  digital_out_pool.destroy((DigitalOut*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE DigitalOut\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOut, write) (uintptr_t handle, int value)
+{
+  LOG_PRINT("[WRAPPER] CALL DigitalOut.write 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), value);
+  ((DigitalOut*) handle)->write(value);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOut, read) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL DigitalOut.read 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  int retval = ((DigitalOut*) handle)->read();
+  LOG_PRINT("[WRAPPER] RETURN DigitalOut.read 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOut, is_connected) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL DigitalOut.is_connected 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  int retval = ((DigitalOut*) handle)->is_connected();
+  LOG_PRINT("[WRAPPER] RETURN DigitalOut.is_connected 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+//
+// - BusOut ---
+//
+static JSObjectPool<BusOut, JSMBED_POOL_SIZE_BUS_OUT> bus_out_pool("BusOut");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(BusOut, PI_I) (const int *pins, int count)
+{
+  // BusOut takes exactly 16 pins, with unused ones NC.
+  PinName bus_pins[16];
+  for (int index = 0; index < 16; index++)
+  {
+    bus_pins[index] = (index < count) ? (PinName) pins[index] : NC;
+  }
+
+  uintptr_t handle = (uintptr_t) bus_out_pool.construct(bus_pins);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE BusOut 0x%x (0x%x) - %d pins\n", handle, *((uint32_t*)handle), count);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(BusOut) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY BusOut 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  bus_out_pool.destroy((BusOut*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE BusOut\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(BusOut, write) (uintptr_t handle, int value)
+{
+  LOG_PRINT("[WRAPPER] CALL BusOut.write 0x%x (0x%x) - 0x%x\n", handle, *((uint32_t*)handle), value);
+  ((BusOut*) handle)->write(value);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(BusOut, read) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL BusOut.read 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  int retval = ((BusOut*) handle)->read();
+  LOG_PRINT("[WRAPPER] RETURN BusOut.read 0x%x (0x%x) ==> 0x%x\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+//
+// - PortOut ---
+//
+static JSObjectPool<PortOut, JSMBED_POOL_SIZE_PORT_OUT> port_out_pool("PortOut");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PortOut, I_I) (int port, int mask)
+{
+  uintptr_t handle = (uintptr_t) port_out_pool.construct((PortName) port, mask);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE PortOut 0x%x (0x%x) - %d 0x%x\n", handle, *((uint32_t*)handle), port, mask);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PortOut) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY PortOut 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  port_out_pool.destroy((PortOut*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE PortOut\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PortOut, write) (uintptr_t handle, int value)
+{
+  LOG_PRINT("[WRAPPER] CALL PortOut.write 0x%x (0x%x) - 0x%x\n", handle, *((uint32_t*)handle), value);
+  ((PortOut*) handle)->write(value);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(PortOut, read) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL PortOut.read 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  int retval = ((PortOut*) handle)->read();
+  LOG_PRINT("[WRAPPER] RETURN PortOut.read 0x%x (0x%x) ==> 0x%x\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+//
+// - DigitalOutGroup ---
+//
+// Up to 32 arbitrary pins, which can be on different ports, driven from one
+// mask. The state of every pin is cached, so that a write only touches the
+// pins whose level actually changes.
+//
+class DigitalOutGroup
+{
+public:
+  DigitalOutGroup(const int *pin_names, int count) :
+    count(count),
+    state(0)
+  {
+    for (int index = 0; index < count; index++)
+    {
+      gpio_init_out(&pins[index], (PinName) pin_names[index]);
+      gpio_write(&pins[index], 0);
+    }
+  }
+
+  void update(uint32_t mask, uint32_t value)
+  {
+    uint32_t valid_mask = (count == 32) ? 0xFFFFFFFF : ((1u << count) - 1);
+    uint32_t changed = (state ^ value) & mask & valid_mask;
+
+    for (int index = 0; changed != 0; index++, changed >>= 1)
+    {
+      if (changed & 1)
+      {
+        gpio_write(&pins[index], (value >> index) & 1);
+      }
+    }
+
+    state = (state & ~mask) | (value & mask & valid_mask);
+  }
+
+  uint32_t read() const
+  {
+    return state;
+  }
+
+private:
+  gpio_t pins[JSMBED_DIGITAL_OUT_GROUP_MAX_PINS];
+  int count;
+  uint32_t state;
+};
+
+static JSObjectPool<DigitalOutGroup, JSMBED_POOL_SIZE_DIGITAL_OUT_GROUP> digital_out_group_pool("DigitalOutGroup");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalOutGroup, PI_I) (const int *pins, int count)
+{
+  uintptr_t handle = (uintptr_t) digital_out_group_pool.construct(pins, count);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE DigitalOutGroup 0x%x - %d pins\n", handle, count);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(DigitalOutGroup) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY DigitalOutGroup 0x%x\n", handle);
+  digital_out_group_pool.destroy((DigitalOutGroup*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE DigitalOutGroup\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOutGroup, update) (uintptr_t handle, uint32_t mask, uint32_t value)
+{
+  LOG_PRINT("[WRAPPER] CALL DigitalOutGroup.update 0x%x - 0x%x 0x%x\n", handle, mask, value);
+  ((DigitalOutGroup*) handle)->update(mask, value);
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOutGroup, read) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL DigitalOutGroup.read 0x%x\n", handle);
+  return ((DigitalOutGroup*) handle)->read();
+}
+
+//
+// - DigitalIn ---
+//
+static JSObjectPool<DigitalIn, JSMBED_POOL_SIZE_DIGITAL_IN> digital_in_pool("DigitalIn");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalIn, I_I) (int pin, int pull)
+{
+  uintptr_t handle = (uintptr_t) digital_in_pool.construct((PinName) pin, (PinMode) pull);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE DigitalIn 0x%x (0x%x) - %d %d\n", handle, *((uint32_t*)handle), pin, pull);
+  return handle;
+}
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalIn, I) (int pin)
+{
+  uintptr_t handle = (uintptr_t) digital_in_pool.construct((PinName) pin);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE DigitalIn 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pin);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(DigitalIn) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY DigitalIn 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  digital_in_pool.destroy((DigitalIn*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE DigitalIn\n");
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalIn, read) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL DigitalIn.read 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  int retval = ((DigitalIn*) handle)->read();
+  LOG_PRINT("[WRAPPER] RETURN DigitalIn.read 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalIn, mode) (uintptr_t handle, int pull)
+{
+  LOG_PRINT("[WRAPPER] CALL DigitalIn.mode 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pull);
+  ((DigitalIn*) handle)->mode((PinMode) pull);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalIn, is_connected) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL DigitalIn.is_connected 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  return ((DigitalIn*) handle)->is_connected();
+}
+
+//
+// Multi-pin inputs remember the last value they read, so that JS can ask
+// which bits changed since the previous scan without a second read or any
+// bookkeeping of its own.
+//
+class InputSnapshot
+{
+public:
+  InputSnapshot() :
+    last(0)
+  {
+  }
+
+  uint32_t take(uint32_t value)
+  {
+    last = value;
+    return value;
+  }
+
+  uint32_t take_changes(uint32_t value)
+  {
+    uint32_t changed = value ^ last;
+    last = value;
+    return changed;
+  }
+
+  uint32_t get_last() const
+  {
+    return last;
+  }
+
+private:
+  uint32_t last;
+};
+
+//
+// - BusIn ---
+//
+class WrappedBusIn : public BusIn, public InputSnapshot
+{
+public:
+  WrappedBusIn(PinName pins[16]) :
+    BusIn(pins)
+  {
+    take(BusIn::read());
+  }
+};
+
+static JSObjectPool<WrappedBusIn, JSMBED_POOL_SIZE_BUS_IN> bus_in_pool("BusIn");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(BusIn, PI_I) (const int *pins, int count)
+{
+  // BusIn takes exactly 16 pins, with unused ones NC.
+  PinName bus_pins[16];
+  for (int index = 0; index < 16; index++)
+  {
+    bus_pins[index] = (index < count) ? (PinName) pins[index] : NC;
+  }
+
+  uintptr_t handle = (uintptr_t) bus_in_pool.construct(bus_pins);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE BusIn 0x%x (0x%x) - %d pins\n", handle, *((uint32_t*)handle), count);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(BusIn) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY BusIn 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  bus_in_pool.destroy((WrappedBusIn*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE BusIn\n");
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, read) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL BusIn.read 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  WrappedBusIn *bus = (WrappedBusIn*) handle;
+  return bus->take(bus->read());
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, changed) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL BusIn.changed 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  WrappedBusIn *bus = (WrappedBusIn*) handle;
+  return bus->take_changes(bus->read());
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, last) (uintptr_t handle)
+{
+  return ((WrappedBusIn*) handle)->get_last();
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, mode) (uintptr_t handle, int pull)
+{
+  LOG_PRINT("[WRAPPER] CALL BusIn.mode 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pull);
+  ((WrappedBusIn*) handle)->mode((PinMode) pull);
+}
+
+//
+// - PortIn ---
+//
+class WrappedPortIn : public PortIn, public InputSnapshot
+{
+public:
+  WrappedPortIn(PortName port, int mask) :
+    PortIn(port, mask)
+  {
+    take(PortIn::read());
+  }
+};
+
+static JSObjectPool<WrappedPortIn, JSMBED_POOL_SIZE_PORT_IN> port_in_pool("PortIn");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PortIn, I_I) (int port, int mask)
+{
+  uintptr_t handle = (uintptr_t) port_in_pool.construct((PortName) port, mask);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE PortIn 0x%x (0x%x) - %d 0x%x\n", handle, *((uint32_t*)handle), port, mask);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PortIn) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY PortIn 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  port_in_pool.destroy((WrappedPortIn*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE PortIn\n");
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, read) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL PortIn.read 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  WrappedPortIn *port = (WrappedPortIn*) handle;
+  return port->take(port->read());
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, changed) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL PortIn.changed 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  WrappedPortIn *port = (WrappedPortIn*) handle;
+  return port->take_changes(port->read());
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, last) (uintptr_t handle)
+{
+  return ((WrappedPortIn*) handle)->get_last();
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, mode) (uintptr_t handle, int pull)
+{
+  LOG_PRINT("[WRAPPER] CALL PortIn.mode 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pull);
+  ((WrappedPortIn*) handle)->mode((PinMode) pull);
+}
+
+//
+// - Asynchronous bus transfers ---
+//
+// Asynchronous transfers run on a single worker thread, shared by every I2C
+// and SPI object, which blocks in the driver so that the event loop doesn't
+// have to. Requests are queued in the order they were made, and each
+// completion is posted back to the event loop, which calls the wrapper's
+// callback.
+//
+#ifndef JSMBED_BUS_ASYNC_STACK_SIZE
+#  define JSMBED_BUS_ASYNC_STACK_SIZE 1024
+#endif
+
+typedef struct bus_async_request {
+  // Does the transfer on the worker thread, and returns the result.
+  int (*transfer)(struct bus_async_request *request);
+  uintptr_t handle;
+  bool is_read;
+  int address;
+  const char *tx;
+  char *rx;
+  int length;
+  bool repeated;
+  int result;
+  jsmbed_bus_async_complete_t complete;
+  void *context;
+} bus_async_request;
+
+static Mail<bus_async_request, JSMBED_BUS_ASYNC_QUEUE_SIZE> bus_async_requests;
+static Thread *bus_async_worker = NULL;
+
+// Called on the event loop once the worker has finished with a request.
+static void bus_async_deliver(void *context)
+{
+  bus_async_request *request = (bus_async_request*) context;
+  LOG_PRINT("[WRAPPER] COMPLETE bus transfer 0x%x ==> %d\n", request->handle, request->result);
+  request->complete(request->context, request->result);
+  bus_async_requests.free(request);
+}
+
+// !!! - Runs on the worker thread - !!!
+//  = No printf, and no jerryscript API.
+static void bus_async_worker_main(void const *argument)
+{
+  while (true)
+  {
+    osEvent evt = bus_async_requests.get(osWaitForever);
+    if (evt.status != osEventMail)
+    {
+      continue;
+    }
+
+    bus_async_request *request = (bus_async_request*) evt.value.p;
+    request->result = request->transfer(request);
+    jsmbed_wrap_post_native_call(bus_async_deliver, request);
+  }
+}
+
+// Queues a copy of the request. Returns false if the queue is full.
+static bool bus_async_post(const bus_async_request *request)
+{
+  bus_async_request *queued = bus_async_requests.alloc();
+  if (queued == NULL)
+  {
+    return false;
+  }
+
+  // Only started once something needs it, since the stack isn't free.
+  if (bus_async_worker == NULL)
+  {
+    bus_async_worker = new Thread(bus_async_worker_main, NULL, osPriorityAboveNormal, JSMBED_BUS_ASYNC_STACK_SIZE);
+  }
+
+  *queued = *request;
+  queued->result = -1;
+  bus_async_requests.put(queued);
+  return true;
+}
+
+//
+// - I2C ---
+//
+// Each I2C object has its own lock, held for the whole of every transfer
+// (and for read-modify-write register updates), so that the bus worker can't
+// interleave an asynchronous transfer with a synchronous one. The lock is
+// recursive, so the register helpers can take it around calls that take it
+// again. The byte-level start/read/write/stop calls only hold it for the one
+// call, so hand-built transactions shouldn't overlap asynchronous transfers.
+//
+class WrappedI2C : public I2C
+{
+public:
+  WrappedI2C(PinName sda, PinName scl) :
+    I2C(sda, scl)
+  {
+  }
+
+  Mutex bus_lock;
+};
+
+class I2CBusLock
+{
+public:
+  explicit I2CBusLock(uintptr_t handle) :
+    i2c((WrappedI2C*) handle)
+  {
+    i2c->bus_lock.lock();
+  }
+
+  ~I2CBusLock()
+  {
+    i2c->bus_lock.unlock();
+  }
+
+private:
+  WrappedI2C *i2c;
+};
+
+static JSObjectPool<WrappedI2C, JSMBED_POOL_SIZE_I2C> i2c_pool("I2C");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(I2C, I_I) (int sda, int scl)
+{
+  uintptr_t handle = (uintptr_t) i2c_pool.construct((PinName) sda, (PinName) scl);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE I2C 0x%x (0x%x) - %d %d\n", handle, *((uint32_t*)handle), sda, scl);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(I2C) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY I2C 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  i2c_pool.destroy((WrappedI2C*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE I2C\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, frequency) (uintptr_t handle, int hz)
+{
+  I2CBusLock lock(handle);
+  LOG_PRINT("[WRAPPER] CALL I2C.frequency 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), hz);
+  ((I2C*) handle)->frequency(hz);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_I_PC_I_B)
+    (uintptr_t handle, int address, char *data, int length, bool repeated)
+{
+  I2CBusLock lock(handle);
+  LOG_PRINT("[WRAPPER] CALL I2C.read 0x%x (0x%x) - %d 0x%x %d %d\n", handle, *((uint32_t*)handle), address, data, length, repeated);
+  int retval = ((I2C*) handle)->read(address, data, length, repeated);
+  LOG_PRINT("[WRAPPER] RETURN I2C.read 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_I) (uintptr_t handle, int ack)
+{
+  I2CBusLock lock(handle);
+  LOG_PRINT("[WRAPPER] CALL I2C.read 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), ack);
+  int retval = ((I2C*) handle)->read(ack);
+  LOG_PRINT("[WRAPPER] RETURN I2C.read 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I_KPC_I_B)
+    (uintptr_t handle, int address, const char *data, int length, bool repeated)
+{
+  I2CBusLock lock(handle);
+  LOG_PRINT("[WRAPPER] CALL I2C.write 0x%x (0x%x) - %d 0x%x %d %d\n", handle, *((uint32_t*)handle), address, data, length, repeated);
+  int retval = ((I2C*) handle)->write(address, data, length, repeated);
+  LOG_PRINT("[WRAPPER] RETURN I2C.write 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I) (uintptr_t handle, int data)
+{
+  I2CBusLock lock(handle);
+  LOG_PRINT("[WRAPPER] CALL I2C.write 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), data);
+  int retval = ((I2C*) handle)->write(data);
+  LOG_PRINT("[WRAPPER] RETURN I2C.write 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, start) (uintptr_t handle)
+{
+  I2CBusLock lock(handle);
+  LOG_PRINT("[WRAPPER] CALL I2C.start 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  ((I2C*) handle)->start();
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, stop) (uintptr_t handle)
+{
+  I2CBusLock lock(handle);
+  LOG_PRINT("[WRAPPER] CALL I2C.stop 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  ((I2C*) handle)->stop();
+}
+
+// !!! - Runs on the bus worker thread - !!!
+static int i2c_async_transfer(bus_async_request *request)
+{
+  I2CBusLock lock(request->handle);
+  I2C *i2c = (I2C*) request->handle;
+  if (request->is_read)
+  {
+    return i2c->read(request->address, request->rx, request->length, request->repeated);
+  }
+  return i2c->write(request->address, request->tx, request->length, request->repeated);
+}
+
+bool NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, transfer_async)
+    (uintptr_t handle, bool is_read, int address, char *data, int length, bool repeated,
+     jsmbed_bus_async_complete_t complete, void *context)
+{
+  LOG_PRINT("[WRAPPER] CALL I2C.transfer_async 0x%x (0x%x) - %d %d 0x%x %d %d\n", handle, *((uint32_t*)handle), is_read, address, data, length, repeated);
+
+  bus_async_request request;
+  request.transfer = i2c_async_transfer;
+  request.handle = handle;
+  request.is_read = is_read;
+  request.address = address;
+  request.tx = data;
+  request.rx = data;
+  request.length = length;
+  request.repeated = repeated;
+  request.complete = complete;
+  request.context = context;
+  return bus_async_post(&request);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, transact) (uintptr_t handle, const jsmbed_i2c_program_t *program)
+{
+  I2CBusLock lock(handle);
+  LOG_PRINT("[WRAPPER] CALL I2C.transact 0x%x (0x%x) - 0x%x %d ops\n", handle, *((uint32_t*)handle), program, program->op_count);
+  I2C *i2c = (I2C*) handle;
+
+  for (int index = 0; index < program->op_count; index++)
+  {
+    const jsmbed_i2c_op_t *op = &program->ops[index];
+    int result = 0;
+    switch (op->code)
+    {
+      case JSMBED_I2C_OP_WRITE:
+        result = i2c->write(op->address, op->data, op->length, op->repeated);
+        break;
+      case JSMBED_I2C_OP_READ:
+        result = i2c->read(op->address, op->data, op->length, op->repeated);
+        break;
+      case JSMBED_I2C_OP_DELAY:
+        wait_us(op->length);
+        break;
+    }
+
+    if (result != 0)
+    {
+      LOG_PRINT("[WRAPPER] RETURN I2C.transact 0x%x (0x%x) ==> op %d failed (%d)\n", handle, *((uint32_t*)handle), index, result);
+      return index + 1;
+    }
+  }
+
+  LOG_PRINT("[WRAPPER] RETURN I2C.transact 0x%x (0x%x) ==> 0\n", handle, *((uint32_t*)handle));
+  return 0;
+}
+
+// Register writes up to this long are sent as one transfer from the stack,
+// longer ones a byte at a time.
+#ifndef JSMBED_I2C_REGISTER_BUFFER_SIZE
+#  define JSMBED_I2C_REGISTER_BUFFER_SIZE 32
+#endif
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_registers)
+    (uintptr_t handle, int address, int reg, char *data, int length)
+{
+  I2CBusLock lock(handle);
+  LOG_PRINT("[WRAPPER] CALL I2C.read_registers 0x%x (0x%x) - %d %d 0x%x %d\n", handle, *((uint32_t*)handle), address, reg, data, length);
+  I2C *i2c = (I2C*) handle;
+  char reg_byte = (char) reg;
+  int retval = i2c->write(address, &reg_byte, 1, true);
+  if (retval == 0)
+  {
+    retval = i2c->read(address, data, length);
+  }
+  LOG_PRINT("[WRAPPER] RETURN I2C.read_registers 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_registers)
+    (uintptr_t handle, int address, int reg, const char *data, int length)
+{
+  I2CBusLock lock(handle);
+  LOG_PRINT("[WRAPPER] CALL I2C.write_registers 0x%x (0x%x) - %d %d 0x%x %d\n", handle, *((uint32_t*)handle), address, reg, data, length);
+  I2C *i2c = (I2C*) handle;
+  int retval = 0;
+
+  if (length < JSMBED_I2C_REGISTER_BUFFER_SIZE)
+  {
+    char buffer[JSMBED_I2C_REGISTER_BUFFER_SIZE];
+    buffer[0] = (char) reg;
+    memcpy(&buffer[1], data, length);
+    retval = i2c->write(address, buffer, length + 1);
+  }
+  else
+  {
+    // I2C.write(int) returns 1 for an ACK.
+    i2c->start();
+    bool acked = (i2c->write(address) == 1) && (i2c->write(reg) == 1);
+    for (int index = 0; acked && index < length; index++)
+    {
+      acked = (i2c->write(data[index]) == 1);
+    }
+    i2c->stop();
+    retval = acked ? 0 : 1;
+  }
+
+  LOG_PRINT("[WRAPPER] RETURN I2C.write_registers 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+static uint32_t jsmbed_i2c_decode_register(const char *data, int bits, bool little_endian)
+{
+  if (bits == 8)
+  {
+    return (uint8_t) data[0];
+  }
+  return little_endian ?
+    (((uint8_t) data[1] << 8) | (uint8_t) data[0]) :
+    (((uint8_t) data[0] << 8) | (uint8_t) data[1]);
+}
+
+static void jsmbed_i2c_encode_register(char *data, int bits, bool little_endian, uint32_t value)
+{
+  if (bits == 8)
+  {
+    data[0] = (char) value;
+  }
+  else if (little_endian)
+  {
+    data[0] = (char) value;
+    data[1] = (char) (value >> 8);
+  }
+  else
+  {
+    data[0] = (char) (value >> 8);
+    data[1] = (char) value;
+  }
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_register)
+    (uintptr_t handle, int address, int reg, int bits, bool little_endian, uint32_t *value)
+{
+  char data[2];
+  int retval = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_registers)(handle, address, reg, data, bits / 8);
+  if (retval == 0)
+  {
+    *value = jsmbed_i2c_decode_register(data, bits, little_endian);
+  }
+  return retval;
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_register)
+    (uintptr_t handle, int address, int reg, int bits, bool little_endian, uint32_t value)
+{
+  char data[2];
+  jsmbed_i2c_encode_register(data, bits, little_endian, value);
+  return NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_registers)(handle, address, reg, data, bits / 8);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, update_bits)
+    (uintptr_t handle, int address, int reg, int bits, bool little_endian, uint32_t mask, uint32_t value)
+{
+  I2CBusLock lock(handle);
+  uint32_t current;
+  int retval = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_register)(handle, address, reg, bits, little_endian, &current);
+  if (retval != 0)
+  {
+    return retval;
+  }
+
+  uint32_t updated = (current & ~mask) | (value & mask);
+  if (updated == current)
+  {
+    return 0;
+  }
+  return NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_register)(handle, address, reg, bits, little_endian, updated);
+}
+
+//
+// - SPI ---
+//
+// Remembers the frame size set with format(), since SPI doesn't expose it,
+// so that block transfers send whole frames.
+class WrappedSPI : public SPI
+{
+public:
+  WrappedSPI(PinName mosi, PinName miso, PinName sclk, PinName ssel = NC) :
+    SPI(mosi, miso, sclk, ssel),
+    bits(8)
+  {
+  }
+
+  void format(int bits, int mode)
+  {
+    SPI::format(bits, mode);
+    this->bits = bits;
+  }
+
+  int get_bits() const
+  {
+    return bits;
+  }
+
+private:
+  int bits;
+};
+
+static JSObjectPool<WrappedSPI, JSMBED_POOL_SIZE_SPI> spi_pool("SPI");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(SPI, I_I_I_I) (int mosi, int miso, int sclk, int ssel)
+{
+  uintptr_t handle = (uintptr_t) spi_pool.construct((PinName) mosi, (PinName) miso, (PinName) sclk, (PinName) ssel);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE SPI 0x%x (0x%x) - %d %d %d %d\n", handle, *((uint32_t*)handle), mosi, miso, sclk, ssel);
+  return handle;
+}
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(SPI, I_I_I) (int mosi, int miso, int sclk)
+{
+  uintptr_t handle = (uintptr_t) spi_pool.construct((PinName) mosi, (PinName) miso, (PinName) sclk);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE SPI 0x%x (0x%x) - %d %d %d\n", handle, *((uint32_t*)handle), mosi, miso, sclk);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(SPI) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY SPI 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  spi_pool.destroy((WrappedSPI*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE SPI\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, format) (uintptr_t handle, int bits, int mode)
+{
+  LOG_PRINT("[WRAPPER] CALL SPI.format 0x%x (0x%x) - %d %d\n", handle, *((uint32_t*)handle), bits, mode);
+  ((WrappedSPI*) handle)->format(bits, mode);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, frequency) (uintptr_t handle, int hz)
+{
+  LOG_PRINT("[WRAPPER] CALL SPI.frequency 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), hz);
+  ((SPI*) handle)->frequency(hz);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, write) (uintptr_t handle, int value)
+{
+  LOG_PRINT("[WRAPPER] CALL SPI.write 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), value);
+  int retval = ((SPI*) handle)->write(value);
+  LOG_PRINT("[WRAPPER] RETURN SPI.write 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
+  return retval;
+}
+
+// Safe to call from the bus worker thread, so no LOG_PRINT.
+//
+// Frames of up to 8 bits are a byte each. Wider ones are 2 (or 4) bytes in
+// native byte order, i.e. the elements of a Uint16Array (or Uint32Array), and
+// any trailing bytes that don't make up a whole frame are left alone.
+// Returns the number of bytes transferred.
+static int spi_transfer(WrappedSPI *spi, const char *tx, char *rx, int length)
+{
+  int bits = spi->get_bits();
+  if (bits <= 8)
+  {
+    for (int index = 0; index < length; index++)
+    {
+      int value = spi->write((tx != NULL) ? (uint8_t) tx[index] : 0xFF);
+      if (rx != NULL)
+      {
+        rx[index] = (char) value;
+      }
+    }
+    return length;
+  }
+
+  int frame_size = (bits <= 16) ? 2 : 4;
+  uint32_t idle = (bits >= 32) ? 0xFFFFFFFF : ((1u << bits) - 1);
+  int frames = length / frame_size;
+  for (int index = 0; index < frames; index++)
+  {
+    int offset = index * frame_size;
+    uint32_t out = idle;
+    if (tx != NULL)
+    {
+      if (frame_size == 2)
+      {
+        uint16_t frame;
+        memcpy(&frame, &tx[offset], sizeof(frame));
+        out = frame;
+      }
+      else
+      {
+        memcpy(&out, &tx[offset], sizeof(out));
+      }
+    }
+
+    uint32_t in = (uint32_t) spi->write((int) out);
+    if (rx != NULL)
+    {
+      if (frame_size == 2)
+      {
+        uint16_t frame = (uint16_t) in;
+        memcpy(&rx[offset], &frame, sizeof(frame));
+      }
+      else
+      {
+        memcpy(&rx[offset], &in, sizeof(in));
+      }
+    }
+  }
+  return frames * frame_size;
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, transfer)
+    (uintptr_t handle, const char *tx, char *rx, int length)
+{
+  LOG_PRINT("[WRAPPER] CALL SPI.transfer 0x%x (0x%x) - 0x%x 0x%x %d\n", handle, *((uint32_t*)handle), tx, rx, length);
+  return spi_transfer((WrappedSPI*) handle, tx, rx, length);
+}
+
+// !!! - Runs on the bus worker thread - !!!
+static int spi_async_transfer(bus_async_request *request)
+{
+  return spi_transfer((WrappedSPI*) request->handle, request->tx, request->rx, request->length);
+}
+
+bool NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, transfer_async)
+    (uintptr_t handle, const char *tx, char *rx, int length,
+     jsmbed_bus_async_complete_t complete, void *context)
+{
+  LOG_PRINT("[WRAPPER] CALL SPI.transfer_async 0x%x (0x%x) - 0x%x 0x%x %d\n", handle, *((uint32_t*)handle), tx, rx, length);
+
+  bus_async_request request;
+  request.transfer = spi_async_transfer;
+  request.handle = handle;
+  request.is_read = (rx != NULL);
+  request.address = 0;
+  request.tx = tx;
+  request.rx = rx;
+  request.length = length;
+  request.repeated = false;
+  request.complete = complete;
+  request.context = context;
+  return bus_async_post(&request);
+}
+
+
+//
+// - Serial ---
+//
+#ifndef JSMBED_SERIAL_RX_BUFFER_SIZE
+#  define JSMBED_SERIAL_RX_BUFFER_SIZE 256
+#endif
+#ifndef JSMBED_SERIAL_TX_BUFFER_SIZE
+#  define JSMBED_SERIAL_TX_BUFFER_SIZE 256
+#endif
+
+// A byte queue with one producer and one consumer, one of which is an ISR.
+// Holds up to N - 1 bytes.
+template<uint32_t N>
+class ByteRing
+{
+public:
+  ByteRing() : head(0), tail(0) {}
+
+  bool empty() const { return head == tail; }
+  uint32_t size() const { return (head + N - tail) % N; }
+  uint32_t space() const { return N - 1 - size(); }
+
+  bool push(char c)
+  {
+    uint32_t next = (head + 1) % N;
+    if (next == tail)
+    {
+      return false;
+    }
+    data[head] = c;
+    head = next;
+    return true;
+  }
+
+  bool pop(char *c)
+  {
+    if (empty())
+    {
+      return false;
+    }
+    *c = data[tail];
+    tail = (tail + 1) % N;
+    return true;
+  }
+
+  // Returns the offset of the first c from the front, or -1.
+  int find(char c) const
+  {
+    for (uint32_t index = tail, offset = 0; index != head; index = (index + 1) % N, offset++)
+    {
+      if (data[index] == c)
+      {
+        return offset;
+      }
+    }
+    return -1;
+  }
+
+private:
+  char data[N];
+  volatile uint32_t head;
+  volatile uint32_t tail;
+};
+
+/*
+ * A serial port whose RX interrupt fills a ring buffer, and posts a single
+ * event to JS once there's something worth reading: a delimiter, at least
+ * threshold bytes, a full buffer, or a pause of idle_us. No further events
+ * are posted until JS reads from the buffer, so a fast stream can't flood the
+ * mailbox; if a complete line (or threshold bytes) is still buffered after a
+ * read, the next event is posted straight away. Writes go into a second ring,
+ * which the TX interrupt drains.
+ */
+class WrappedSerial : public RawSerial
+{
+public:
+  WrappedSerial(PinName tx, PinName rx) :
+    RawSerial(tx, rx),
+    delimiter('\n'),
+    threshold(0),
+    idle_us(0),
+    has_callback(false),
+    event_pending(false),
+    tx_active(false),
+    overflow_count(0)
+  {
+    attach(this, &WrappedSerial::on_rx, RxIrq);
+  }
+
+  ~WrappedSerial()
+  {
+    attach(NULL, RxIrq);
+    attach(NULL, TxIrq);
+    idle.detach();
+  }
+
+  void set_data_callback(jerry_object_t *f)
+  {
+    has_callback = false;
+    if (f != NULL)
+    {
+      mailman_for_data.set_post_function(f);
+      has_callback = true;
+    }
+    else
+    {
+      mailman_for_data.unset_post_function();
+    }
+    event_pending = false;
+  }
+
+  void set_delimiter(int c) { delimiter = c; }
+  void set_threshold(int n) { threshold = n; }
+  void set_idle_timeout(int us) { idle_us = us; }
+
+  int available() const { return rx_ring.size(); }
+  uint32_t get_overflows() const { return overflow_count; }
+  jsmbed_wrap_native_link_t *get_link() { return &link; }
+
+  int read(char *data, int length)
+  {
+    int count = 0;
+    while (count < length && rx_ring.pop(&data[count]))
+    {
+      count++;
+    }
+    rearm(false);
+    return count;
+  }
+
+  // Returns -1 if there's no complete line. Lines longer than length are
+  // truncated, and the rest discarded. If the buffer fills up without a
+  // delimiter, its contents are returned as a line, since the delimiter
+  // could otherwise never arrive.
+  int read_line(char *data, int length)
+  {
+    int line_length = (delimiter >= 0) ? rx_ring.find((char) delimiter) : -1;
+    bool delimited = (line_length >= 0);
+    if (!delimited)
+    {
+      if (rx_ring.space() > 0)
+      {
+        rearm(true);
+        return -1;
+      }
+      line_length = rx_ring.size();
+    }
+
+    char c;
+    for (int index = 0; index < line_length; index++)
+    {
+      rx_ring.pop(&c);
+      if (index < length)
+      {
+        data[index] = c;
+      }
+    }
+    if (delimited)
+    {
+      rx_ring.pop(&c);
+    }
+    rearm(false);
+    return (line_length < length) ? line_length : length;
+  }
+
+  // Queues as much as fits, and returns how much that was.
+  int write(const char *data, int length)
+  {
+    int count = 0;
+    while (count < length && tx_ring.push(data[count]))
+    {
+      count++;
+    }
+
+    __disable_irq();
+    if (!tx_active && !tx_ring.empty())
+    {
+      tx_active = true;
+      attach(this, &WrappedSerial::on_tx, TxIrq);
+    }
+    __enable_irq();
+    return count;
+  }
+
+private:
+  // !!! - ISR - !!!
+  void on_rx()
+  {
+    while (readable())
+    {
+      char c = (char) getc();
+      if (!rx_ring.push(c))
+      {
+        overflow_count++;
+      }
+      if (c == delimiter)
+      {
+        post_event();
+      }
+    }
+
+    if ((threshold > 0 && rx_ring.size() >= (uint32_t) threshold) || rx_ring.space() == 0)
+    {
+      post_event();
+    }
+    if (idle_us > 0)
+    {
+      idle.attach_us(this, &WrappedSerial::on_idle, idle_us);
+    }
+  }
+
+  // !!! - ISR - !!!
+  void on_idle()
+  {
+    if (!rx_ring.empty())
+    {
+      post_event();
+    }
+  }
+
+  // !!! - ISR - !!!
+  void on_tx()
+  {
+    char c;
+    while (writeable() && tx_ring.pop(&c))
+    {
+      putc(c);
+    }
+    if (tx_ring.empty())
+    {
+      tx_active = false;
+      attach(NULL, TxIrq);
+    }
+  }
+
+  // !!! - ISR - !!!
+  void post_event()
+  {
+    if (has_callback && !event_pending)
+    {
+      event_pending = true;
+      send_event();
+    }
+  }
+
+  void send_event()
+  {
+    jerry_value_t available_value;
+    available_value.type = JERRY_DATA_TYPE_UINT32;
+    available_value.u.v_uint32 = rx_ring.size();
+    mailman_for_data.post_call_callback_msg_1arg(available_value);
+  }
+
+  bool has_line() const
+  {
+    return (delimiter >= 0 && rx_ring.find((char) delimiter) >= 0) || rx_ring.space() == 0;
+  }
+
+  // Called once JS has read. Lets the ISR post the next event, or posts it
+  // now if there's already a line (or, unless line_only, threshold bytes)
+  // waiting, since the bytes that would have triggered it have arrived. The
+  // check is done with interrupts masked so that it can't race on_rx, but
+  // the post is not, since RTOS calls can't be made with them masked.
+  void rearm(bool line_only)
+  {
+    core_util_critical_section_enter();
+    event_pending = false;
+    bool ready = has_callback &&
+        (has_line() || (!line_only && threshold > 0 && rx_ring.size() >= (uint32_t) threshold));
+    if (ready)
+    {
+      event_pending = true;
+    }
+    core_util_critical_section_exit();
+
+    if (ready)
+    {
+      send_event();
+    }
+  }
+
+  ByteRing<JSMBED_SERIAL_RX_BUFFER_SIZE> rx_ring;
+  ByteRing<JSMBED_SERIAL_TX_BUFFER_SIZE> tx_ring;
+  Timeout idle;
+  JSFunctionMailman mailman_for_data;
+
+  int delimiter;
+  int threshold;
+  int idle_us;
+  volatile bool has_callback;
+  volatile bool event_pending;
+  volatile bool tx_active;
+  volatile uint32_t overflow_count;
+  // Framer.feed recognises a Serial by this.
+  jsmbed_wrap_native_link_t link;
+};
+
+static JSObjectPool<WrappedSerial, JSMBED_POOL_SIZE_SERIAL> serial_pool("Serial");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(Serial, I_I) (int tx, int rx)
+{
+  uintptr_t handle = (uintptr_t) serial_pool.construct((PinName) tx, (PinName) rx);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE Serial 0x%x (0x%x) - %d %d\n", handle, *((uint32_t*)handle), tx, rx);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Serial) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY Serial 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  serial_pool.destroy((WrappedSerial*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE Serial\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, baud) (uintptr_t handle, int rate)
+{
+  LOG_PRINT("[WRAPPER] CALL Serial.baud 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), rate);
+  ((WrappedSerial*) handle)->baud(rate);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, on_data) (uintptr_t handle, jerry_object_t *fptr)
+{
+  LOG_PRINT("[WRAPPER] CALL Serial.on_data 0x%x (0x%x) - 0x%x\n", handle, *((uint32_t*)handle), fptr);
+  ((WrappedSerial*) handle)->set_data_callback(fptr);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, set_delimiter) (uintptr_t handle, int delimiter)
+{
+  LOG_PRINT("[WRAPPER] CALL Serial.set_delimiter 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), delimiter);
+  ((WrappedSerial*) handle)->set_delimiter(delimiter);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, set_threshold) (uintptr_t handle, int threshold)
+{
+  LOG_PRINT("[WRAPPER] CALL Serial.set_threshold 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), threshold);
+  ((WrappedSerial*) handle)->set_threshold(threshold);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, set_idle_timeout) (uintptr_t handle, int us)
+{
+  LOG_PRINT("[WRAPPER] CALL Serial.set_idle_timeout 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), us);
+  ((WrappedSerial*) handle)->set_idle_timeout(us);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, available) (uintptr_t handle)
+{
+  return ((WrappedSerial*) handle)->available();
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, read) (uintptr_t handle, char *data, int length)
+{
+  LOG_PRINT("[WRAPPER] CALL Serial.read 0x%x (0x%x) - 0x%x %d\n", handle, *((uint32_t*)handle), data, length);
+  return ((WrappedSerial*) handle)->read(data, length);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, read_line) (uintptr_t handle, char *data, int length)
+{
+  LOG_PRINT("[WRAPPER] CALL Serial.read_line 0x%x (0x%x) - 0x%x %d\n", handle, *((uint32_t*)handle), data, length);
+  return ((WrappedSerial*) handle)->read_line(data, length);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, write) (uintptr_t handle, const char *data, int length)
+{
+  LOG_PRINT("[WRAPPER] CALL Serial.write 0x%x (0x%x) - 0x%x %d\n", handle, *((uint32_t*)handle), data, length);
+  return ((WrappedSerial*) handle)->write(data, length);
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, overflows) (uintptr_t handle)
+{
+  return ((WrappedSerial*) handle)->get_overflows();
+}
+
+jsmbed_wrap_native_link_t *NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, link) (uintptr_t handle)
+{
+  return ((WrappedSerial*) handle)->get_link();
+}
+
+//
+// - Framer ---
+//
+// Frames decoded payloads out of a byte stream, and encodes payloads into
+// it, with COBS (0x00 delimited), SLIP (RFC 1055) or a 16-bit big-endian
+// length prefix. Optionally, each payload is followed by its CRC-16/CCITT
+// (polynomial 0x1021, initial value 0xFFFF), big-endian, which is checked
+// and stripped when decoding.
+//
+#ifndef JSMBED_FRAMER_MAX_FRAME_SIZE
+#  define JSMBED_FRAMER_MAX_FRAME_SIZE 256
+#endif
+#ifndef JSMBED_FRAMER_QUEUE_SIZE
+#  define JSMBED_FRAMER_QUEUE_SIZE 512
+#endif
+
+#define SLIP_END 0xC0
+#define SLIP_ESC 0xDB
+#define SLIP_ESC_END 0xDC
+#define SLIP_ESC_ESC 0xDD
+
+static uint16_t crc16_ccitt(const char *data, int length)
+{
+  // One entry per nibble, which keeps the table small.
+  static const uint16_t table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+  };
+
+  uint16_t crc = 0xFFFF;
+  for (int index = 0; index < length; index++)
+  {
+    uint8_t byte = (uint8_t) data[index];
+    crc = (crc << 4) ^ table[(crc >> 12) ^ (byte >> 4)];
+    crc = (crc << 4) ^ table[(crc >> 12) ^ (byte & 0x0F)];
+  }
+  return crc;
+}
+
+class Framer
+{
+public:
+  Framer(jsmbed_framer_type_t type, bool crc) :
+    type(type),
+    crc(crc),
+    queued_frames(0)
+  {
+    reset_frame();
+    reset_stats();
+  }
+
+  int push(const char *data, int length)
+  {
+    for (int index = 0; index < length; index++)
+    {
+      push_byte((uint8_t) data[index]);
+    }
+    return queued_frames;
+  }
+
+  int read(char *data, int length)
+  {
+    if (queued_frames == 0)
+    {
+      return -1;
+    }
+
+    char high, low, c;
+    queue.pop(&high);
+    queue.pop(&low);
+    int frame_length = ((uint8_t) high << 8) | (uint8_t) low;
+    for (int index = 0; index < frame_length; index++)
+    {
+      queue.pop(&c);
+      if (index < length)
+      {
+        data[index] = c;
+      }
+    }
+    queued_frames--;
+    return frame_length;
+  }
+
+  int encode(const char *payload, int payload_length, char *out, int out_length)
+  {
+    char crc_bytes[2];
+    if (crc)
+    {
+      uint16_t value = crc16_ccitt(payload, payload_length);
+      crc_bytes[0] = (char) (value >> 8);
+      crc_bytes[1] = (char) value;
+    }
+
+    Output output(out, out_length);
+    switch (type)
+    {
+      case JSMBED_FRAMER_COBS:
+        encode_cobs(&output, payload, payload_length, crc_bytes);
+        break;
+      case JSMBED_FRAMER_SLIP:
+        output.put(SLIP_END);
+        encode_slip(&output, payload, payload_length);
+        if (crc)
+        {
+          encode_slip(&output, crc_bytes, 2);
+        }
+        output.put(SLIP_END);
+        break;
+      case JSMBED_FRAMER_LENGTH_PREFIXED:
+      {
+        int length = payload_length + (crc ? 2 : 0);
+        output.put(length >> 8);
+        output.put(length);
+        output.put(payload, payload_length);
+        if (crc)
+        {
+          output.put(crc_bytes, 2);
+        }
+        break;
+      }
+    }
+    return output.overflowed ? -1 : output.length;
+  }
+
+  const jsmbed_framer_stats_t *get_stats() const { return &stats; }
+
+  void reset_stats()
+  {
+    memset(&stats, 0, sizeof(stats));
+  }
+
+private:
+  // Writes into a caller's buffer, noting rather than overrunning the end.
+  struct Output
+  {
+    Output(char *data, int size) : data(data), size(size), length(0), overflowed(false) {}
+
+    void put(int c)
+    {
+      if (length < size)
+      {
+        data[length++] = (char) c;
+      }
+      else
+      {
+        overflowed = true;
+      }
+    }
+
+    void put(const char *bytes, int count)
+    {
+      for (int index = 0; index < count; index++)
+      {
+        put(bytes[index]);
+      }
+    }
+
+    char *data;
+    int size;
+    int length;
+    bool overflowed;
+  };
+
+  void encode_cobs(Output *output, const char *payload, int payload_length, const char *crc_bytes)
+  {
+    int total = payload_length + (crc ? 2 : 0);
+    int code_index = output->length;
+    uint8_t code = 1;
+    output->put(0);
+
+    for (int index = 0; index < total; index++)
+    {
+      char c = (index < payload_length) ? payload[index] : crc_bytes[index - payload_length];
+      if (c != 0)
+      {
+        output->put(c);
+        code++;
+      }
+      if (c == 0 || code == 0xFF)
+      {
+        if (code_index < output->size)
+        {
+          output->data[code_index] = (char) code;
+        }
+        code = 1;
+        code_index = output->length;
+        output->put(0);
+      }
+    }
+
+    if (code_index < output->size)
+    {
+      output->data[code_index] = (char) code;
+    }
+    output->put(0);
+  }
+
+  void encode_slip(Output *output, const char *bytes, int count)
+  {
+    for (int index = 0; index < count; index++)
+    {
+      uint8_t c = (uint8_t) bytes[index];
+      if (c == SLIP_END)
+      {
+        output->put(SLIP_ESC);
+        output->put(SLIP_ESC_END);
+      }
+      else if (c == SLIP_ESC)
+      {
+        output->put(SLIP_ESC);
+        output->put(SLIP_ESC_ESC);
+      }
+      else
+      {
+        output->put(c);
+      }
+    }
+  }
+
+  void reset_frame()
+  {
+    frame_length = 0;
+    frame_error = false;
+    escaped = false;
+    cobs_remaining = 0;
+    cobs_code = 0xFF;
+    expected_length = -1;
+  }
+
+  void append(uint8_t c)
+  {
+    if (frame_length < JSMBED_FRAMER_MAX_FRAME_SIZE)
+    {
+      frame[frame_length++] = (char) c;
+    }
+    else
+    {
+      frame_error = true;
+    }
+  }
+
+  void push_byte(uint8_t c)
+  {
+    switch (type)
+    {
+      case JSMBED_FRAMER_COBS:
+        if (c == 0)
+        {
+          if (cobs_remaining != 0)
+          {
+            frame_error = true;
+          }
+          end_frame();
+        }
+        else if (cobs_remaining == 0)
+        {
+          // Every code but the first, and those following a full block,
+          // stands for a zero.
+          if (cobs_code != 0xFF)
+          {
+            append(0);
+          }
+          cobs_code = c;
+          cobs_remaining = c - 1;
+        }
+        else
+        {
+          append(c);
+          cobs_remaining--;
+        }
+        break;
+
+      case JSMBED_FRAMER_SLIP:
+        if (c == SLIP_END)
+        {
+          end_frame();
+        }
+        else if (escaped)
+        {
+          escaped = false;
+          if (c == SLIP_ESC_END)
+          {
+            append(SLIP_END);
+          }
+          else if (c == SLIP_ESC_ESC)
+          {
+            append(SLIP_ESC);
+          }
+          else
+          {
+            frame_error = true;
+          }
+        }
+        else if (c == SLIP_ESC)
+        {
+          escaped = true;
+        }
+        else
+        {
+          append(c);
+        }
+        break;
+
+      case JSMBED_FRAMER_LENGTH_PREFIXED:
+        if (expected_length < 0)
+        {
+          // The two length bytes are collected in the frame buffer.
+          frame[frame_length++] = (char) c;
+          if (frame_length == 2)
+          {
+            expected_length = ((uint8_t) frame[0] << 8) | (uint8_t) frame[1];
+            frame_length = 0;
+            if (expected_length > JSMBED_FRAMER_MAX_FRAME_SIZE)
+            {
+              // There's no way to resynchronise, so skip the header.
+              stats.framing_errors++;
+              reset_frame();
+            }
+            else if (expected_length == 0)
+            {
+              end_frame();
+            }
+          }
+        }
+        else
+        {
+          append(c);
+          if (frame_length == expected_length)
+          {
+            end_frame();
+          }
+        }
+        break;
+    }
+  }
+
+  void end_frame()
+  {
+    // Back-to-back delimiters are allowed, and just mean an empty frame.
+    if (frame_length == 0 && !frame_error && type != JSMBED_FRAMER_LENGTH_PREFIXED)
+    {
+      reset_frame();
+      return;
+    }
+
+    int payload_length = frame_length;
+    if (frame_error)
+    {
+      stats.framing_errors++;
+    }
+    else if (crc && (frame_length < 2 ||
+             crc16_ccitt(frame, frame_length - 2) !=
+               (((uint8_t) frame[frame_length - 2] << 8) | (uint8_t) frame[frame_length - 1])))
+    {
+      stats.crc_errors++;
+    }
+    else
+    {
+      if (crc)
+      {
+        payload_length -= 2;
+      }
+      if (queue.space() < (uint32_t) payload_length + 2)
+      {
+        stats.overflows++;
+      }
+      else
+      {
+        queue.push((char) (payload_length >> 8));
+        queue.push((char) payload_length);
+        for (int index = 0; index < payload_length; index++)
+        {
+          queue.push(frame[index]);
+        }
+        queued_frames++;
+        stats.frames++;
+      }
+    }
+    reset_frame();
+  }
+
+  jsmbed_framer_type_t type;
+  bool crc;
+
+  // The frame being decoded.
+  char frame[JSMBED_FRAMER_MAX_FRAME_SIZE];
+  int frame_length;
+  bool frame_error;
+  bool escaped;
+  int cobs_remaining;
+  uint8_t cobs_code;
+  int expected_length;
+
+  // Decoded frames, each preceded by its 16-bit length.
+  ByteRing<JSMBED_FRAMER_QUEUE_SIZE> queue;
+  int queued_frames;
+
+  jsmbed_framer_stats_t stats;
+};
+
+static JSObjectPool<Framer, JSMBED_POOL_SIZE_FRAMER> framer_pool("Framer");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(Framer, I_B) (int type, bool crc)
+{
+  uintptr_t handle = (uintptr_t) framer_pool.construct((jsmbed_framer_type_t) type, crc);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE Framer 0x%x (0x%x) - %d %d\n", handle, *((uint32_t*)handle), type, crc);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Framer) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY Framer 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  framer_pool.destroy((Framer*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE Framer\n");
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, push) (uintptr_t handle, const char *data, int length)
+{
+  LOG_PRINT("[WRAPPER] CALL Framer.push 0x%x (0x%x) - 0x%x %d\n", handle, *((uint32_t*)handle), data, length);
+  return ((Framer*) handle)->push(data, length);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, feed) (uintptr_t handle, uintptr_t serial_handle)
+{
+  LOG_PRINT("[WRAPPER] CALL Framer.feed 0x%x (0x%x) - 0x%x\n", handle, *((uint32_t*)handle), serial_handle);
+  Framer *framer = (Framer*) handle;
+  WrappedSerial *serial = (WrappedSerial*) serial_handle;
+
+  char chunk[32];
+  int frames = 0;
+  int count;
+  do
+  {
+    count = serial->read(chunk, sizeof(chunk));
+    frames = framer->push(chunk, count);
+  } while (count == sizeof(chunk));
+  return frames;
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, read) (uintptr_t handle, char *data, int length)
+{
+  LOG_PRINT("[WRAPPER] CALL Framer.read 0x%x (0x%x) - 0x%x %d\n", handle, *((uint32_t*)handle), data, length);
+  return ((Framer*) handle)->read(data, length);
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, encode)
+    (uintptr_t handle, const char *payload, int payload_length, char *out, int out_length)
+{
+  LOG_PRINT("[WRAPPER] CALL Framer.encode 0x%x (0x%x) - 0x%x %d 0x%x %d\n", handle, *((uint32_t*)handle), payload, payload_length, out, out_length);
+  return ((Framer*) handle)->encode(payload, payload_length, out, out_length);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, stats) (uintptr_t handle, jsmbed_framer_stats_t *stats)
+{
+  *stats = *((Framer*) handle)->get_stats();
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, reset_stats) (uintptr_t handle)
+{
+  ((Framer*) handle)->reset_stats();
+}
+
+//
+// - AnalogIn ---
+//
+static JSObjectPool<AnalogIn, JSMBED_POOL_SIZE_ANALOG_IN> analog_in_pool("AnalogIn");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(AnalogIn, I) (int pin)
+{
+  uintptr_t handle = (uintptr_t) analog_in_pool.construct((PinName) pin);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE AnalogIn 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pin);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(AnalogIn) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY AnalogIn 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  analog_in_pool.destroy((AnalogIn*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE AnalogIn\n");
+}
+
+float NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogIn, read) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL AnalogIn.read 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  return ((AnalogIn*) handle)->read();
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogIn, read_u16) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL AnalogIn.read_u16 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  return ((AnalogIn*) handle)->read_u16();
+}
+
+//
+// - AnalogSampler ---
+//
+// Sampling runs from a Ticker interrupt, into two JS-owned Uint16Arrays in
+// turn, so that JS can work on one block while the other fills. The HAL is
+// used directly because AnalogIn takes a mutex, which can't be done from an
+// interrupt.
+//
+// A full block is handed to the event loop as a native call rather than
+// posted straight to the mailman, since posting a value from the interrupt
+// would mean acquiring it there. The sampler itself can't go away while a
+// hand-off is queued, because it is only released, through the same
+// mailbox, after stop.
+//
+class AnalogSampler
+{
+public:
+  AnalogSampler(PinName pin) :
+    owner(NULL),
+    generation(0),
+    is_running(false),
+    overrun_count(0)
+  {
+    analogin_init(&input, pin);
+    for (int index = 0; index < 2; index++)
+    {
+      blocks[index].sampler = this;
+      blocks[index].object = NULL;
+      blocks[index].data = NULL;
+      blocks[index].pending = false;
+      blocks[index].generation = 0;
+    }
+  }
+
+  ~AnalogSampler()
+  {
+    stop();
+  }
+
+  // The wrapper has acquired owner and the blocks, and they're released
+  // again by stop.
+  void start(jerry_object_t *owner, int period_us, int decimation,
+             jerry_object_t *block_a, uint16_t *data_a,
+             jerry_object_t *block_b, uint16_t *data_b,
+             int length, jerry_object_t *fptr)
+  {
+    stop();
+
+    this->owner = owner;
+    blocks[0].object = block_a;
+    blocks[0].data = data_a;
+    blocks[1].object = block_b;
+    blocks[1].data = data_b;
+    // pending is left alone: a block handed off by the last run stays
+    // pending until its delivery has run and been ignored.
+    generation++;
+    mailman_for_block.set_post_function(fptr);
+
+    this->decimation = (decimation < 1) ? 1 : decimation;
+    this->length = length;
+    active = 0;
+    filled = 0;
+    sum = 0;
+    summed = 0;
+    is_running = true;
+    ticker.attach_us(this, &AnalogSampler::on_tick, (timestamp_t) period_us);
+  }
+
+  void stop()
+  {
+    if (!is_running)
+    {
+      return;
+    }
+
+    ticker.detach();
+    is_running = false;
+
+    // Anything already queued for the event loop sees that the sampler has
+    // stopped and does nothing, and these releases arrive after it.
+    mailman_for_block.unset_post_function();
+    jsmbed_wrap_post_release(blocks[0].object);
+    jsmbed_wrap_post_release(blocks[1].object);
+    jsmbed_wrap_post_release(owner);
+    blocks[0].object = NULL;
+    blocks[1].object = NULL;
+    owner = NULL;
+  }
+
+  bool running() const
+  {
+    return is_running;
+  }
+
+  uint32_t overruns() const
+  {
+    return overrun_count;
+  }
+
+private:
+  struct Block {
+    AnalogSampler *sampler;
+    jerry_object_t *object;
+    uint16_t *data;
+    // Set from the interrupt when the block is full, cleared once it has
+    // been handed to JS, or straight away if the hand-off was dropped.
+    volatile bool pending;
+    // The run that handed the block off. Only written while the block
+    // isn't pending, so it still names that run when the delivery comes.
+    uint32_t generation;
+  };
+
+  void on_tick()
+  {
+    sum += analogin_read_u16(&input);
+    if (++summed < decimation)
+    {
+      return;
+    }
+
+    Block *block = &blocks[active];
+    block->data[filled++] = (uint16_t) (sum / decimation);
+    sum = 0;
+    summed = 0;
+    if (filled < length)
+    {
+      return;
+    }
+
+    filled = 0;
+    active ^= 1;
+    if (block->pending)
+    {
+      // JS hasn't been handed the previous contents yet, so this lot
+      // replaces them rather than queueing a second call.
+      overrun_count++;
+      return;
+    }
+    block->pending = true;
+    block->generation = generation;
+    if (!jsmbed_wrap_post_native_call(&AnalogSampler::deliver, block))
+    {
+      // The mailbox was full. The block is lost, but the next one can
+      // still be handed off.
+      overrun_count++;
+      block->pending = false;
+    }
+  }
+
+  // Runs on the event loop.
+  static void deliver(void *context)
+  {
+    Block *block = (Block*) context;
+    AnalogSampler *sampler = block->sampler;
+    bool is_current = (block->generation == sampler->generation);
+    block->pending = false;
+    // Queued before a stop, or before a stop and start in the same turn, in
+    // which case the block now belongs to the new run and isn't full yet.
+    if (!sampler->is_running || !is_current)
+    {
+      return;
+    }
+
+    // Released by the event loop once the callback has been called.
+    jerry_value_t value;
+    value.type = JERRY_DATA_TYPE_OBJECT;
+    value.u.v_object = jerry_acquire_object(block->object);
+    sampler->mailman_for_block.post_call_callback_msg_1arg(value);
+  }
+
+  analogin_t input;
+  Ticker ticker;
+  JSFunctionMailman mailman_for_block;
+  jerry_object_t *owner;
+  Block blocks[2];
+  // Counts runs, so that deliveries queued by an earlier one are ignored.
+  uint32_t generation;
+
+  int length;
+  uint32_t decimation;
+  volatile bool is_running;
+  int active;
+  int filled;
+  uint32_t sum;
+  uint32_t summed;
+  volatile uint32_t overrun_count;
+};
+
+static JSObjectPool<AnalogSampler, JSMBED_POOL_SIZE_ANALOG_SAMPLER> analog_sampler_pool("AnalogSampler");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(AnalogSampler, I) (int pin)
+{
+  uintptr_t handle = (uintptr_t) analog_sampler_pool.construct((PinName) pin);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE AnalogSampler 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pin);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(AnalogSampler) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY AnalogSampler 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  analog_sampler_pool.destroy((AnalogSampler*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE AnalogSampler\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, start)
+    (uintptr_t handle, jerry_object_t *owner, int period_us, int decimation,
+     jerry_object_t *block_a, uint16_t *data_a, jerry_object_t *block_b, uint16_t *data_b,
+     int length, jerry_object_t *fptr)
+{
+  LOG_PRINT("[WRAPPER] CALL AnalogSampler.start 0x%x (0x%x) - %d %d %d 0x%x\n", handle, *((uint32_t*)handle), period_us, decimation, length, fptr);
+  ((AnalogSampler*) handle)->start(owner, period_us, decimation, block_a, data_a, block_b, data_b, length, fptr);
+  LOG_PRINT("[WRAPPER] CALL-COMPLETE AnalogSampler.start\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, stop) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL AnalogSampler.stop 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  ((AnalogSampler*) handle)->stop();
+  LOG_PRINT("[WRAPPER] CALL-COMPLETE AnalogSampler.stop\n");
+}
+
+bool NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, running) (uintptr_t handle)
+{
+  return ((AnalogSampler*) handle)->running();
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, overruns) (uintptr_t handle)
+{
+  return ((AnalogSampler*) handle)->overruns();
+}
+
+//
+// - PwmOut ---
+//
+// Ramps and sequences update the duty cycle from a Ticker interrupt, so a
+// fade costs one event-loop callback when it finishes, rather than one per
+// step. Only the ISR touches the running state once the Ticker is
+// attached, and the Ticker is always detached before it's changed from
+// the JS thread. While one runs, the JS object is held, so that dropping
+// the last reference to a busy PwmOut doesn't stop it (or free it under
+// the ISR).
+//
+#ifndef JSMBED_PWM_RAMP_STEP_US
+#  define JSMBED_PWM_RAMP_STEP_US 2000
+#endif
+#ifndef JSMBED_PWM_MIN_STEP_US
+#  define JSMBED_PWM_MIN_STEP_US 50
+#endif
+
+class WrappedPwmOut : public PwmOut
+{
+public:
+  WrappedPwmOut(PinName pin) :
+    PwmOut(pin),
+    state(IDLE),
+    has_callback(false),
+    owner(NULL),
+    sequence_object(NULL)
+  {
+    LOG_PRINT("[WRAPPER] CONSTRUCTOR WrappedPwmOut 0x%x (0x%x) - %d\n", this, *((uint32_t*)this), pin);
+  }
+
+  ~WrappedPwmOut()
+  {
+    LOG_PRINT("[WRAPPER] DESTRUCTOR WrappedPwmOut 0x%x (0x%x)\n", this, *((uint32_t*)this));
+    stop();
+    LOG_PRINT("[WRAPPER] DESTRUCTOR-COMPLETE WrappedPwmOut\n");
+  }
+
+  void ramp_to(jerry_object_t *owner, float duty, int ms, jsmbed_pwm_curve_t curve, jerry_object_t *fptr)
+  {
+    stop();
+    set_done_callback(fptr);
+    this->owner = owner;
+
+    ramp_curve = curve;
+    ramp_from = read();
+    ramp_target = duty;
+    if (curve == JSMBED_PWM_CURVE_GAMMA)
+    {
+      ramp_from = sqrtf(ramp_from);
+      ramp_target = sqrtf(ramp_target);
+    }
+    // In 64 bits, since ms * 1000 overflows an int after about 35 minutes.
+    int64_t ramp_steps = ((int64_t) ms * 1000) / JSMBED_PWM_RAMP_STEP_US;
+    steps = (ramp_steps < 1) ? 1 : (ramp_steps > INT_MAX) ? INT_MAX : (int) ramp_steps;
+    step = 0;
+    state = RAMPING;
+    ticker.attach_us(this, &WrappedPwmOut::on_ramp_step, JSMBED_PWM_RAMP_STEP_US);
+  }
+
+  void play_sequence(jerry_object_t *owner, jerry_object_t *sequence, const void *data, bool is_u16, int length,
+                     int step_us, bool loop, jerry_object_t *fptr)
+  {
+    stop();
+    set_done_callback(fptr);
+    this->owner = owner;
+
+    sequence_object = sequence;
+    sequence_data = data;
+    sequence_is_u16 = is_u16;
+    sequence_loop = loop;
+    steps = length;
+    step = 0;
+    state = SEQUENCING;
+    // The first value is written now, rather than a step late.
+    on_sequence_step();
+    if (state == SEQUENCING)
+    {
+      ticker.attach_us(this, &WrappedPwmOut::on_sequence_step,
+          (timestamp_t) ((step_us < JSMBED_PWM_MIN_STEP_US) ? JSMBED_PWM_MIN_STEP_US : step_us));
+    }
+  }
+
+  void stop()
+  {
+    // Once detached, the ISR can't run, so the state can't change under us.
+    ticker.detach();
+    if (state == IDLE)
+    {
+      return;
+    }
+    state = IDLE;
+    release_sequence();
+    set_done_callback(NULL);
+    release_owner();
+  }
+
+  bool busy() const
+  {
+    return state != IDLE;
+  }
+
+private:
+  enum State {
+    IDLE,
+    RAMPING,
+    SEQUENCING
+  };
+
+  void set_done_callback(jerry_object_t *fptr)
+  {
+    if (fptr != NULL)
+    {
+      mailman_for_done.set_post_function(fptr);
+      has_callback = true;
+    }
+    else if (has_callback)
+    {
+      mailman_for_done.unset_post_function();
+      has_callback = false;
+    }
+  }
+
+  void release_sequence()
+  {
+    if (sequence_object != NULL)
+    {
+      // After the completion call, if there is one.
+      jsmbed_wrap_post_release(sequence_object);
+      sequence_object = NULL;
+    }
+  }
+
+  void release_owner()
+  {
+    if (owner != NULL)
+    {
+      jsmbed_wrap_post_release(owner);
+      owner = NULL;
+    }
+  }
+
+  // !!! - Called in ISR code - !!!
+  void finish()
+  {
+    ticker.detach();
+    state = IDLE;
+    if (has_callback)
+    {
+      mailman_for_done.post_call_callback_msg();
+    }
+    release_sequence();
+    release_owner();
+  }
+
+  // !!! - Called in ISR code - !!!
+  void on_ramp_step()
+  {
+    step++;
+    float t = (float) step / steps;
+    if (ramp_curve == JSMBED_PWM_CURVE_SMOOTH)
+    {
+      t = t * t * (3.0f - 2.0f * t);
+    }
+    float duty = ramp_from + (ramp_target - ramp_from) * t;
+    if (ramp_curve == JSMBED_PWM_CURVE_GAMMA)
+    {
+      duty = duty * duty;
+    }
+    write(duty);
+
+    if (step >= steps)
+    {
+      finish();
+    }
+  }
+
+  // !!! - Called in ISR code - !!!
+  void on_sequence_step()
+  {
+    if (sequence_is_u16)
+    {
+      write(((const uint16_t*) sequence_data)[step] / 65535.0f);
+    }
+    else
+    {
+      write(((const float*) sequence_data)[step]);
+    }
+
+    if (++step >= steps)
+    {
+      if (sequence_loop)
+      {
+        step = 0;
+      }
+      else
+      {
+        finish();
+      }
+    }
+  }
+
+  Ticker ticker;
+  JSFunctionMailman mailman_for_done;
+  volatile State state;
+  bool has_callback;
+  jerry_object_t *owner;
+
+  int step;
+  int steps;
 
-void NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOut, write) (uintptr_t handle, int value)
+  jsmbed_pwm_curve_t ramp_curve;
+  float ramp_from;
+  float ramp_target;
+
+  jerry_object_t *sequence_object;
+  const void *sequence_data;
+  bool sequence_is_u16;
+  bool sequence_loop;
+};
+
+static JSObjectPool<WrappedPwmOut, JSMBED_POOL_SIZE_PWM_OUT> pwm_out_pool("PwmOut");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PwmOut, I) (int pin)
 {
-  LOG_PRINT("[WRAPPER] CALL DigitalOut.write 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), value);
-  ((DigitalOut*) handle)->write(value);
+  LOG_PRINT("[WRAPPER] CREATE PwmOut\n");
+  uintptr_t handle = (uintptr_t) pwm_out_pool.construct((PinName) pin);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE-COMPLETE PwmOut 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pin);
+  return handle;
 }
 
-int NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOut, read) (uintptr_t handle)
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PwmOut) (uintptr_t handle)
 {
-  LOG_PRINT("[WRAPPER] CALL DigitalOut.read 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
-  int retval = ((DigitalOut*) handle)->read();
-  LOG_PRINT("[WRAPPER] RETURN DigitalOut.read 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
-  return retval;
+  LOG_PRINT("[WRAPPER] DESTROY PwmOut 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  pwm_out_pool.destroy((WrappedPwmOut*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE PwmOut\n");
 }
 
-int NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOut, is_connected) (uintptr_t handle)
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, period) (uintptr_t handle, float seconds)
 {
-  LOG_PRINT("[WRAPPER] CALL DigitalOut.is_connected 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
-  int retval = ((DigitalOut*) handle)->is_connected();
-  LOG_PRINT("[WRAPPER] RETURN DigitalOut.is_connected 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
-  return retval;
+  LOG_PRINT("[WRAPPER] CALL PwmOut.period 0x%x (0x%x) - %f\n", handle, *((uint32_t*)handle), seconds);
+  ((WrappedPwmOut*) handle)->stop();
+  ((WrappedPwmOut*) handle)->period(seconds);
 }
 
-//
-// - I2C ---
-//
-uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(I2C, I_I) (int sda, int scl)
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, period_us) (uintptr_t handle, int us)
 {
-  uintptr_t handle = (uintptr_t) new I2C((PinName) sda, (PinName) scl);
-  LOG_PRINT("[WRAPPER] CREATE I2C 0x%x (0x%x) - %d %d\n", handle, *((uint32_t*)handle), sda, scl);
-  return handle;
+  LOG_PRINT("[WRAPPER] CALL PwmOut.period_us 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), us);
+  ((WrappedPwmOut*) handle)->stop();
+  ((WrappedPwmOut*) handle)->period_us(us);
 }
 
-void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(I2C) (uintptr_t handle)
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, pulsewidth) (uintptr_t handle, float seconds)
 {
-  LOG_PRINT("[WRAPPER] DESTROY I2C 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
-  delete (I2C*) handle;
-  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE I2C\n");
+  LOG_PRINT("[WRAPPER] CALL PwmOut.pulsewidth 0x%x (0x%x) - %f\n", handle, *((uint32_t*)handle), seconds);
+  ((WrappedPwmOut*) handle)->stop();
+  ((WrappedPwmOut*) handle)->pulsewidth(seconds);
 }
 
-void NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, frequency) (uintptr_t handle, int hz)
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, pulsewidth_us) (uintptr_t handle, int us)
 {
-  LOG_PRINT("[WRAPPER] CALL I2C.frequency 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), hz);
-  ((I2C*) handle)->frequency(hz);
+  LOG_PRINT("[WRAPPER] CALL PwmOut.pulsewidth_us 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), us);
+  ((WrappedPwmOut*) handle)->stop();
+  ((WrappedPwmOut*) handle)->pulsewidth_us(us);
 }
 
-int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_I_PC_I_B)
-    (uintptr_t handle, int address, char *data, int length, bool repeated)
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, write) (uintptr_t handle, float duty)
 {
-  LOG_PRINT("[WRAPPER] CALL I2C.read 0x%x (0x%x) - %d 0x%x %d %d\n", handle, *((uint32_t*)handle), address, data, length, repeated);
-  int retval = ((I2C*) handle)->read(address, data, length, repeated);
-  LOG_PRINT("[WRAPPER] RETURN I2C.read 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
-  return retval;
+  LOG_PRINT("[WRAPPER] CALL PwmOut.write 0x%x (0x%x) - %f\n", handle, *((uint32_t*)handle), duty);
+  ((WrappedPwmOut*) handle)->stop();
+  ((WrappedPwmOut*) handle)->write(duty);
 }
 
-int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_I) (uintptr_t handle, int ack)
+float NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, read) (uintptr_t handle)
 {
-  LOG_PRINT("[WRAPPER] CALL I2C.read 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), ack);
-  int retval = ((I2C*) handle)->read(ack);
-  LOG_PRINT("[WRAPPER] RETURN I2C.read 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
-  return retval;
+  LOG_PRINT("[WRAPPER] CALL PwmOut.read 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  return ((WrappedPwmOut*) handle)->read();
 }
 
-int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I_KPC_I_B)
-    (uintptr_t handle, int address, const char *data, int length, bool repeated)
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, ramp_to)
+    (uintptr_t handle, jerry_object_t *owner, float duty, int ms, int curve, jerry_object_t *fptr)
 {
-  LOG_PRINT("[WRAPPER] CALL I2C.write 0x%x (0x%x) - %d 0x%x %d %d\n", handle, *((uint32_t*)handle), address, data, length, repeated);
-  int retval = ((I2C*) handle)->write(address, data, length, repeated);
-  LOG_PRINT("[WRAPPER] RETURN I2C.write 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
-  return retval;
+  LOG_PRINT("[WRAPPER] CALL PwmOut.ramp_to 0x%x (0x%x) - %f %d %d 0x%x\n", handle, *((uint32_t*)handle), duty, ms, curve, fptr);
+  ((WrappedPwmOut*) handle)->ramp_to(owner, duty, ms, (jsmbed_pwm_curve_t) curve, fptr);
+  LOG_PRINT("[WRAPPER] CALL-COMPLETE PwmOut.ramp_to\n");
 }
 
-int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I) (uintptr_t handle, int data)
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, play_sequence)
+    (uintptr_t handle, jerry_object_t *owner, jerry_object_t *sequence, const void *data, bool is_u16, int length,
+     int step_us, bool loop, jerry_object_t *fptr)
 {
-  LOG_PRINT("[WRAPPER] CALL I2C.write 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), data);
-  int retval = ((I2C*) handle)->write(data);
-  LOG_PRINT("[WRAPPER] RETURN I2C.write 0x%x (0x%x) ==> %d\n", handle, *((uint32_t*)handle), retval);
-  return retval;
+  LOG_PRINT("[WRAPPER] CALL PwmOut.play_sequence 0x%x (0x%x) - 0x%x %d %d %d 0x%x\n", handle, *((uint32_t*)handle), data, length, step_us, loop, fptr);
+  ((WrappedPwmOut*) handle)->play_sequence(owner, sequence, data, is_u16, length, step_us, loop, fptr);
+  LOG_PRINT("[WRAPPER] CALL-COMPLETE PwmOut.play_sequence\n");
 }
 
-void NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, start) (uintptr_t handle)
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, stop) (uintptr_t handle)
 {
-  LOG_PRINT("[WRAPPER] CALL I2C.start 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
-  ((I2C*) handle)->start();
+  LOG_PRINT("[WRAPPER] CALL PwmOut.stop 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  ((WrappedPwmOut*) handle)->stop();
 }
 
-void NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, stop) (uintptr_t handle)
+bool NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, busy) (uintptr_t handle)
 {
-  LOG_PRINT("[WRAPPER] CALL I2C.stop 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
-  ((I2C*) handle)->stop();
+  return ((WrappedPwmOut*) handle)->busy();
 }
 
-
 //
 // - Ticker ---
 //
 class WrappedTicker : public Ticker
 {
 public:
-  WrappedTicker() :
-    mailman_for_attach(new JSFunctionMailman())
+  WrappedTicker()
   {
     LOG_PRINT("[WRAPPER] CONSTRUCTOR WrappedTicker 0x%x (0x%x)\n", this, *((uint32_t*)this));
   }
@@ -153,37 +2514,42 @@ public:
   ~WrappedTicker()
   {
     LOG_PRINT("[WRAPPER] DESTRUCTOR WrappedTicker 0x%x (0x%x)\n", this, *((uint32_t*)this));
-    delete mailman_for_attach;
     LOG_PRINT("[WRAPPER] DESTRUCTOR-COMPLETE WrappedTicker\n");
   }
 
   void set_attach_callback(jerry_object_t *f)
   {
     LOG_PRINT("[WRAPPER] SET-CALLBACK WrappedTicker.attach 0x%x (0x%x) - 0x%x\n", this, *((uint32_t*)this), f);
-    mailman_for_attach->set_post_function(f);
+    mailman_for_attach.set_post_function(f);
     LOG_PRINT("[WRAPPER] SET-CALLBACK-COMPLETE WrappedTicker.attach\n");
   }
 
   void unset_attach_callback()
   {
     LOG_PRINT("[WRAPPER] UNSET-CALLBACK WrappedTicker.attach 0x%x (0x%x)\n", this, *((uint32_t*)this));
-    mailman_for_attach->unset_post_function();
+    mailman_for_attach.unset_post_function();
     LOG_PRINT("[WRAPPER] SET-CALLBACK-COMPLETE WrappedTicker.attach\n");
   }
 
   JSFunctionMailman *get_attach_mailman()
   {
-    return mailman_for_attach;
+    return &mailman_for_attach;
   }
 
 private:
-  JSFunctionMailman *mailman_for_attach;
+  JSFunctionMailman mailman_for_attach;
 };
 
+static JSObjectPool<WrappedTicker, JSMBED_POOL_SIZE_TICKER> ticker_pool("Ticker");
+
 uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(Ticker, _) ()
 {
   LOG_PRINT("[WRAPPER] CREATE Ticker\n");
-  uintptr_t handle = (uintptr_t) new WrappedTicker();
+  uintptr_t handle = (uintptr_t) ticker_pool.construct();
+  if (handle == 0)
+  {
+    return 0;
+  }
   LOG_PRINT("[WRAPPER] CREATE-COMPLETE Ticker 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
   return handle;
 }
@@ -192,7 +2558,7 @@ void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Ticker) (uintptr_t handle)
 {
   LOG_PRINT("[WRAPPER] DESTROY Ticker 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
   ((WrappedTicker*) handle)->detach();
-  delete (WrappedTicker*) handle;
+  ticker_pool.destroy((WrappedTicker*) handle);
   LOG_PRINT("[WRAPPER] DESTROY-COMPLETE Ticker\n");
 }
 
@@ -230,13 +2596,52 @@ void NAME_FOR_CLASS_NATIVE_FUNCTION(Ticker, detach) (uintptr_t handle)
 //
 // - InterruptIn ---
 //
+// Edges are taken by WrappedInterruptIn itself rather than posted straight
+// to the mailmen, so that they can be filtered before anything reaches JS:
+//
+//  - samples: the pin is read this many times on each edge, spaced
+//    JSMBED_INTERRUPT_IN_SAMPLE_SPACING_US apart, and the majority level is
+//    taken, so that glitches shorter than the spacing are ignored. Reads
+//    back to back would all land inside the same glitch. The spacing is
+//    busy-waited in the ISR, so it's kept to a few microseconds: the most
+//    samples cost (JSMBED_INTERRUPT_IN_MAX_SAMPLES - 1) * 2us = 28us per
+//    edge by default.
+//  - debounce_us: after an edge has been passed on, further edges are
+//    ignored for this long.
+//  - stable_us: the level has to stay the same for this long before the
+//    edge is passed on. Every edge restarts the wait.
+//
+// Only changes of the filtered level are passed on. If edges are ignored
+// while the level is still changing, the pin is checked again once the
+// debounce window (or stable time) is over, so the final level is never
+// missed.
+//
+// Each edge passed on is stamped with us_ticker_read() in the ISR (for a
+// filtered edge, the time of the first raw edge of the change), which JS
+// gets as the callback's argument. Edges can also just be counted, without
+// posting anything.
+//
+#ifndef JSMBED_INTERRUPT_IN_MAX_SAMPLES
+#  define JSMBED_INTERRUPT_IN_MAX_SAMPLES 15
+#endif
+#ifndef JSMBED_INTERRUPT_IN_SAMPLE_SPACING_US
+#  define JSMBED_INTERRUPT_IN_SAMPLE_SPACING_US 2
+#endif
+
 class WrappedInterruptIn : public InterruptIn
 {
 public:
   WrappedInterruptIn(PinName pin) :
     InterruptIn(pin),
-    mailman_for_rise(new JSFunctionMailman()),
-    mailman_for_fall(new JSFunctionMailman())
+    has_rise_callback(false),
+    has_fall_callback(false),
+    count_edges(JSMBED_INTERRUPT_IN_COUNT_NONE),
+    edge_count(0),
+    filtering(false),
+    debounce_us(0),
+    stable_us(0),
+    samples(1),
+    change_pending(false)
   {
     LOG_PRINT("[WRAPPER] CONSTRUCTOR WrappedInterruptIn 0x%x (0x%x) - %d\n", this, *((uint32_t*)this), pin);
   }
@@ -244,58 +2649,273 @@ public:
   ~WrappedInterruptIn()
   {
     LOG_PRINT("[WRAPPER] DESTRUCTOR WrappedInterruptIn 0x%x (0x%x)\n", this, *((uint32_t*)this));
-    delete mailman_for_rise;
-    delete mailman_for_fall;
+    rise(0);
+    fall(0);
+    settle.detach();
     LOG_PRINT("[WRAPPER] DESTRUCTOR-COMPLETE WrappedInterruptIn\n");
   }
 
   void set_rise_callback(jerry_object_t *f)
   {
     LOG_PRINT("[WRAPPER] SET-CALLBACK WrappedInterruptIn.rise 0x%x (0x%x) - 0x%x\n", this, *((uint32_t*)this), f);
-    mailman_for_rise->set_post_function(f);
+    mailman_for_rise.set_post_function(f);
+    has_rise_callback = true;
+    update_irqs();
     LOG_PRINT("[WRAPPER] SET-CALLBACK-COMPLETE WrappedInterruptIn.rise\n");
   }
 
   void unset_rise_callback()
   {
     LOG_PRINT("[WRAPPER] UNSET-CALLBACK WrappedInterruptIn.rise 0x%x (0x%x)\n", this, *((uint32_t*)this));
-    mailman_for_rise->unset_post_function();
+    has_rise_callback = false;
+    update_irqs();
+    mailman_for_rise.unset_post_function();
     LOG_PRINT("[WRAPPER] UNSET-CALLBACK-COMPLETE WrappedInterruptIn.rise\n");
   }
 
   void set_fall_callback(jerry_object_t *f)
   {
     LOG_PRINT("[WRAPPER] SET-CALLBACK WrappedInterruptIn.fall 0x%x (0x%x) - 0x%x\n", this, *((uint32_t*)this), f);
-    mailman_for_fall->set_post_function(f);
+    mailman_for_fall.set_post_function(f);
+    has_fall_callback = true;
+    update_irqs();
     LOG_PRINT("[WRAPPER] SET-CALLBACK-COMPLETE WrappedInterruptIn.fall\n");
   }
 
   void unset_fall_callback()
   {
     LOG_PRINT("[WRAPPER] UNSET-CALLBACK WrappedInterruptIn.fall 0x%x (0x%x)\n", this, *((uint32_t*)this));
-    mailman_for_fall->unset_post_function();
+    has_fall_callback = false;
+    update_irqs();
+    mailman_for_fall.unset_post_function();
     LOG_PRINT("[WRAPPER] UNSET-CALLBACK-COMPLETE WrappedInterruptIn.fall\n");
   }
 
-  JSFunctionMailman *get_rise_mailman()
+  void set_filter(int debounce_us, int stable_us, int samples)
+  {
+    // Quiet the interrupts while the settings change underneath them.
+    rise(0);
+    fall(0);
+    settle.detach();
+
+    this->debounce_us = (debounce_us > 0) ? debounce_us : 0;
+    this->stable_us = (stable_us > 0) ? stable_us : 0;
+    if (samples < 1)
+    {
+      samples = 1;
+    }
+    else if (samples > JSMBED_INTERRUPT_IN_MAX_SAMPLES)
+    {
+      samples = JSMBED_INTERRUPT_IN_MAX_SAMPLES;
+    }
+    this->samples = samples;
+    filtering = (this->debounce_us > 0 || this->stable_us > 0 || this->samples > 1);
+
+    level = sample();
+    last_change_us = us_ticker_read() - this->debounce_us;
+    change_pending = false;
+    update_irqs();
+  }
+
+  void set_count_edges(jsmbed_interrupt_in_count_t edges)
+  {
+    count_edges = edges;
+    update_irqs();
+  }
+
+  uint32_t get_count() const
   {
-    return mailman_for_rise;
+    return edge_count;
   }
 
-  JSFunctionMailman *get_fall_mailman()
+  uint32_t reset_count()
   {
-    return mailman_for_fall;
+    core_util_critical_section_enter();
+    uint32_t count = edge_count;
+    edge_count = 0;
+    core_util_critical_section_exit();
+    return count;
   }
 
 private:
-  JSFunctionMailman *mailman_for_rise;
-  JSFunctionMailman *mailman_for_fall;
+  // Both edges are needed to follow the level once it's being filtered,
+  // even if JS only wants one of them.
+  void update_irqs()
+  {
+    bool wants_rise = has_rise_callback || (count_edges & JSMBED_INTERRUPT_IN_COUNT_RISE);
+    bool wants_fall = has_fall_callback || (count_edges & JSMBED_INTERRUPT_IN_COUNT_FALL);
+
+    if (wants_rise || (filtering && wants_fall))
+    {
+      rise(this, &WrappedInterruptIn::on_rise);
+    }
+    else
+    {
+      rise(0);
+    }
+
+    if (wants_fall || (filtering && wants_rise))
+    {
+      fall(this, &WrappedInterruptIn::on_fall);
+    }
+    else
+    {
+      fall(0);
+    }
+  }
+
+  // !!! - Called in ISR code - !!!
+  int sample()
+  {
+    int high = read();
+    for (int index = 1; index < samples; index++)
+    {
+      wait_us(JSMBED_INTERRUPT_IN_SAMPLE_SPACING_US);
+      high += read();
+    }
+    return (high * 2 > samples) ? 1 : 0;
+  }
+
+  // The pin and us-ticker interrupts may run at different priorities and
+  // preempt each other, so edge_count and the filter state are only touched
+  // inside critical sections. The reads in sample(), arming the Timeout and
+  // posting to the mailmen all happen outside them.
+
+  // !!! - Called in ISR code - !!!
+  void post_level(int new_level, uint32_t timestamp)
+  {
+    if (count_edges & (new_level ? JSMBED_INTERRUPT_IN_COUNT_RISE : JSMBED_INTERRUPT_IN_COUNT_FALL))
+    {
+      core_util_critical_section_enter();
+      edge_count++;
+      core_util_critical_section_exit();
+    }
+
+    jerry_value_t value;
+    value.type = JERRY_DATA_TYPE_UINT32;
+    value.u.v_uint32 = timestamp;
+    if (new_level && has_rise_callback)
+    {
+      mailman_for_rise.post_call_callback_msg_1arg(value);
+    }
+    else if (!new_level && has_fall_callback)
+    {
+      mailman_for_fall.post_call_callback_msg_1arg(value);
+    }
+  }
+
+  // !!! - Called in ISR code - !!!
+  void on_edge(int edge_level)
+  {
+    uint32_t now = us_ticker_read();
+    if (!filtering)
+    {
+      post_level(edge_level, now);
+      return;
+    }
+
+    core_util_critical_section_enter();
+    if (!change_pending)
+    {
+      change_pending = true;
+      change_started_us = now;
+    }
+
+    uint32_t since_change = now - last_change_us;
+    bool settling = (stable_us > 0 || since_change < debounce_us);
+    uint32_t wait = stable_us;
+    if (since_change < debounce_us && debounce_us - since_change > wait)
+    {
+      wait = debounce_us - since_change;
+    }
+    core_util_critical_section_exit();
+
+    if (settling)
+    {
+      // Come back once the level has had time to settle.
+      settle.attach_us(this, &WrappedInterruptIn::on_settle, wait);
+      return;
+    }
+
+    check_level(now);
+  }
+
+  // !!! - Called in ISR code - !!!
+  void check_level(uint32_t now)
+  {
+    int new_level = sample();
+    uint32_t timestamp = now;
+
+    core_util_critical_section_enter();
+    bool changed = (new_level != level);
+    if (changed)
+    {
+      level = new_level;
+      last_change_us = now;
+      if (change_pending)
+      {
+        timestamp = change_started_us;
+      }
+    }
+    change_pending = false;
+    core_util_critical_section_exit();
+
+    if (changed)
+    {
+      post_level(new_level, timestamp);
+    }
+  }
+
+  // !!! - Called in ISR code - !!!
+  void on_settle()
+  {
+    check_level(us_ticker_read());
+  }
+
+  // !!! - Called in ISR code - !!!
+  void on_rise()
+  {
+    on_edge(1);
+  }
+
+  // !!! - Called in ISR code - !!!
+  void on_fall()
+  {
+    on_edge(0);
+  }
+
+  JSFunctionMailman mailman_for_rise;
+  JSFunctionMailman mailman_for_fall;
+  bool has_rise_callback;
+  bool has_fall_callback;
+
+  jsmbed_interrupt_in_count_t count_edges;
+  volatile uint32_t edge_count;
+
+  bool filtering;
+  uint32_t debounce_us;
+  uint32_t stable_us;
+  int samples;
+
+  Timeout settle;
+  // The filtered level, and when it last changed.
+  int level;
+  uint32_t last_change_us;
+  // Whether there have been edges since, and when the first was.
+  bool change_pending;
+  uint32_t change_started_us;
 };
 
+static JSObjectPool<WrappedInterruptIn, JSMBED_POOL_SIZE_INTERRUPT_IN> interrupt_in_pool("InterruptIn");
+
 uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(InterruptIn, I) (int pin)
 {
   LOG_PRINT("[WRAPPER] CREATE InterruptIn\n");
-  uintptr_t handle = (uintptr_t) new WrappedInterruptIn((PinName) pin);
+  uintptr_t handle = (uintptr_t) interrupt_in_pool.construct((PinName) pin);
+  if (handle == 0)
+  {
+    return 0;
+  }
   LOG_PRINT("[WRAPPER] CREATE-COMPLETE InterruptIn 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pin);
   return handle;
 }
@@ -303,9 +2923,7 @@ uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(InterruptIn, I) (int pin)
 void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(InterruptIn) (uintptr_t handle)
 {
   LOG_PRINT("[WRAPPER] DESTROY InterruptIn 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
-  ((WrappedInterruptIn*) handle)->rise(0);
-  ((WrappedInterruptIn*) handle)->fall(0);
-  delete (WrappedInterruptIn*) handle;
+  interrupt_in_pool.destroy((WrappedInterruptIn*) handle);
   LOG_PRINT("[WRAPPER] DESTROY-COMPLETE InterruptIn\n");
 }
 
@@ -317,13 +2935,10 @@ void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, rise) (uintptr_t handle, jerry_
   if (fptr != 0)
   {
     this_interruptin->set_rise_callback(fptr);
-    this_interruptin->rise(this_interruptin->get_rise_mailman(),
-      (void (JSFunctionMailman::*)(void)) &JSFunctionMailman::post_call_callback_msg);
   }
   else
   {
     this_interruptin->unset_rise_callback();
-    this_interruptin->rise(0);
   }
   LOG_PRINT("[WRAPPER] CALL-COMPLETE InterruptIn.rise\n");
 }
@@ -336,17 +2951,39 @@ void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, fall) (uintptr_t handle, jerry_
   if (fptr != 0)
   {
     this_interruptin->set_fall_callback(fptr);
-    this_interruptin->fall(this_interruptin->get_fall_mailman(),
-      (void (JSFunctionMailman::*)(void)) &JSFunctionMailman::post_call_callback_msg);
   }
   else
   {
     this_interruptin->unset_fall_callback();
-    this_interruptin->fall(0);
   }
   LOG_PRINT("[WRAPPER] CALL-COMPLETE InterruptIn.fall\n");
 }
 
+void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, debounce)
+    (uintptr_t handle, int debounce_us, int stable_us, int samples)
+{
+  LOG_PRINT("[WRAPPER] CALL InterruptIn.debounce 0x%x (0x%x) - %d %d %d\n", handle, *((uint32_t*)handle), debounce_us, stable_us, samples);
+  ((WrappedInterruptIn*) handle)->set_filter(debounce_us, stable_us, samples);
+  LOG_PRINT("[WRAPPER] CALL-COMPLETE InterruptIn.debounce\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, count_edges) (uintptr_t handle, int edges)
+{
+  LOG_PRINT("[WRAPPER] CALL InterruptIn.count_edges 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), edges);
+  ((WrappedInterruptIn*) handle)->set_count_edges((jsmbed_interrupt_in_count_t) edges);
+  LOG_PRINT("[WRAPPER] CALL-COMPLETE InterruptIn.count_edges\n");
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, count) (uintptr_t handle)
+{
+  return ((WrappedInterruptIn*) handle)->get_count();
+}
+
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, reset_count) (uintptr_t handle)
+{
+  return ((WrappedInterruptIn*) handle)->reset_count();
+}
+
 void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, mode) (uintptr_t handle, int pull)
 {
   LOG_PRINT("[WRAPPER] CALL InterruptIn.mode 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pull);
@@ -367,3 +3004,385 @@ void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, enable_irq) (uintptr_t handle)
   ((InterruptIn*) handle)->enable_irq();
   LOG_PRINT("[WRAPPER] CALL-COMPLETE InterruptIn.enable_irq\n");
 }
+
+//
+// - PulseIn ---
+//
+// Times every edge in the ISR, and keeps moving averages of the high and
+// low widths and the period over the last few measurements. JS can read
+// them at any time, or have them reported from the event loop at a fixed
+// rate, which, like AnalogSampler, keeps the PulseIn alive until stop.
+//
+#ifndef JSMBED_PULSE_IN_MAX_WINDOW
+#  define JSMBED_PULSE_IN_MAX_WINDOW 32
+#endif
+#ifndef JSMBED_PULSE_IN_DEFAULT_WINDOW
+#  define JSMBED_PULSE_IN_DEFAULT_WINDOW 8
+#endif
+#ifndef JSMBED_PULSE_IN_DEFAULT_TIMEOUT_US
+#  define JSMBED_PULSE_IN_DEFAULT_TIMEOUT_US 1000000
+#endif
+
+// Moving average of the last size values.
+class PulseWindow
+{
+public:
+  void reset(int size)
+  {
+    this->size = size;
+    count = 0;
+    next = 0;
+    sum = 0;
+  }
+
+  void push(uint32_t value)
+  {
+    if (count == size)
+    {
+      sum -= values[next];
+    }
+    else
+    {
+      count++;
+    }
+    values[next] = value;
+    sum += value;
+    next = (next + 1 == size) ? 0 : next + 1;
+  }
+
+  uint32_t average() const
+  {
+    return (count > 0) ? (uint32_t) (sum / count) : 0;
+  }
+
+private:
+  uint32_t values[JSMBED_PULSE_IN_MAX_WINDOW];
+  uint64_t sum;
+  int size;
+  int count;
+  int next;
+};
+
+class WrappedPulseIn : public InterruptIn
+{
+public:
+  WrappedPulseIn(PinName pin) :
+    InterruptIn(pin),
+    owner(NULL),
+    box(NULL),
+    is_running(false),
+    report_pending(false)
+  {
+    set_window(JSMBED_PULSE_IN_DEFAULT_WINDOW, JSMBED_PULSE_IN_DEFAULT_TIMEOUT_US);
+    rise(this, &WrappedPulseIn::on_rise);
+    fall(this, &WrappedPulseIn::on_fall);
+  }
+
+  ~WrappedPulseIn()
+  {
+    stop();
+    rise(0);
+    fall(0);
+  }
+
+  void set_window(int periods, int timeout_us)
+  {
+    if (periods < 1)
+    {
+      periods = 1;
+    }
+    else if (periods > JSMBED_PULSE_IN_MAX_WINDOW)
+    {
+      periods = JSMBED_PULSE_IN_MAX_WINDOW;
+    }
+
+    core_util_critical_section_enter();
+    window = periods;
+    this->timeout_us = (timeout_us > 0) ? timeout_us : JSMBED_PULSE_IN_DEFAULT_TIMEOUT_US;
+    clear();
+    pulses = 0;
+    core_util_critical_section_exit();
+  }
+
+  // !!! - Called in ISR code - !!!
+  // Also called from JS, so this nests in whatever critical section the
+  // caller may be in rather than unmasking interrupts at the end.
+  void snapshot(jsmbed_pulse_in_stats_t *stats, bool take_pulses)
+  {
+    core_util_critical_section_enter();
+    if ((has_rise || has_fall) && us_ticker_read() - last_edge_us > timeout_us)
+    {
+      // The signal has stopped, so old measurements no longer describe it.
+      clear();
+    }
+    stats->high_us = high.average();
+    stats->low_us = low.average();
+    stats->period_us = period.average();
+    stats->pulses = pulses;
+    if (take_pulses)
+    {
+      pulses = 0;
+    }
+    core_util_critical_section_exit();
+
+    // Rounded to the nearest milli-Hz and thousandth.
+    if (stats->period_us > 0)
+    {
+      stats->frequency_mhz = (1000000000u + stats->period_us / 2) / stats->period_us;
+    }
+    else
+    {
+      stats->frequency_mhz = 0;
+    }
+    uint64_t total_us = (uint64_t) stats->high_us + stats->low_us;
+    if (total_us > 0)
+    {
+      stats->duty_permille = (uint32_t) (((uint64_t) stats->high_us * 1000 + total_us / 2) / total_us);
+    }
+    else
+    {
+      // No edges, so the pin is stuck at one level.
+      stats->duty_permille = read() ? 1000 : 0;
+    }
+  }
+
+  // The wrapper has acquired owner, and it's released again by stop.
+  void start(jerry_object_t *owner, int report_ms, jsmbed_pulse_in_box_t box, jerry_object_t *fptr)
+  {
+    stop();
+
+    this->owner = owner;
+    this->box = box;
+    mailman_for_report.set_post_function(fptr);
+    report_pending = false;
+    is_running = true;
+    reporter.attach_us(this, &WrappedPulseIn::on_report, (timestamp_t) report_ms * 1000);
+  }
+
+  void stop()
+  {
+    reporter.detach();
+    if (!is_running)
+    {
+      return;
+    }
+    is_running = false;
+
+    // As for AnalogSampler.stop.
+    mailman_for_report.unset_post_function();
+    jsmbed_wrap_post_release(owner);
+    owner = NULL;
+  }
+
+private:
+  void clear()
+  {
+    high.reset(window);
+    low.reset(window);
+    period.reset(window);
+    has_rise = false;
+    has_fall = false;
+  }
+
+  // !!! - Called in ISR code - !!!
+  void on_rise()
+  {
+    uint32_t now = us_ticker_read();
+    if (has_fall)
+    {
+      low.push(now - last_fall_us);
+    }
+    if (has_rise)
+    {
+      period.push(now - last_rise_us);
+      pulses++;
+    }
+    last_rise_us = now;
+    last_edge_us = now;
+    has_rise = true;
+  }
+
+  // !!! - Called in ISR code - !!!
+  void on_fall()
+  {
+    uint32_t now = us_ticker_read();
+    if (has_rise)
+    {
+      high.push(now - last_rise_us);
+    }
+    last_fall_us = now;
+    last_edge_us = now;
+    has_fall = true;
+  }
+
+  // !!! - Called in ISR code - !!!
+  void on_report()
+  {
+    if (report_pending)
+    {
+      // JS is behind, so the pulses are carried over to the next report.
+      return;
+    }
+    snapshot(&report, true);
+    report_pending = true;
+    if (!jsmbed_wrap_post_native_call(&WrappedPulseIn::deliver, this))
+    {
+      // The mailbox was full, so this report is dropped. Its pulses go
+      // back to be counted in the next one, which is tried as usual.
+      core_util_critical_section_enter();
+      pulses += report.pulses;
+      core_util_critical_section_exit();
+      report_pending = false;
+    }
+  }
+
+  // Runs on the event loop.
+  static void deliver(void *context)
+  {
+    WrappedPulseIn *pulse_in = (WrappedPulseIn*) context;
+    jsmbed_pulse_in_stats_t stats = pulse_in->report;
+    pulse_in->report_pending = false;
+    if (!pulse_in->is_running)
+    {
+      return;
+    }
+
+    // Released by the event loop once the callback has been called.
+    jerry_value_t value;
+    value.type = JERRY_DATA_TYPE_OBJECT;
+    value.u.v_object = pulse_in->box(&stats);
+    pulse_in->mailman_for_report.post_call_callback_msg_1arg(value);
+  }
+
+  PulseWindow high;
+  PulseWindow low;
+  PulseWindow period;
+  int window;
+  uint32_t timeout_us;
+
+  bool has_rise;
+  bool has_fall;
+  uint32_t last_rise_us;
+  uint32_t last_fall_us;
+  uint32_t last_edge_us;
+  uint32_t pulses;
+
+  Ticker reporter;
+  JSFunctionMailman mailman_for_report;
+  jerry_object_t *owner;
+  jsmbed_pulse_in_box_t box;
+  volatile bool is_running;
+  volatile bool report_pending;
+  jsmbed_pulse_in_stats_t report;
+};
+
+static JSObjectPool<WrappedPulseIn, JSMBED_POOL_SIZE_PULSE_IN> pulse_in_pool("PulseIn");
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PulseIn, I) (int pin)
+{
+  uintptr_t handle = (uintptr_t) pulse_in_pool.construct((PinName) pin);
+  if (handle == 0)
+  {
+    return 0;
+  }
+  LOG_PRINT("[WRAPPER] CREATE PulseIn 0x%x (0x%x) - %d\n", handle, *((uint32_t*)handle), pin);
+  return handle;
+}
+
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PulseIn) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] DESTROY PulseIn 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  pulse_in_pool.destroy((WrappedPulseIn*) handle);
+  LOG_PRINT("[WRAPPER] DESTROY-COMPLETE PulseIn\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, window) (uintptr_t handle, int periods, int timeout_us)
+{
+  LOG_PRINT("[WRAPPER] CALL PulseIn.window 0x%x (0x%x) - %d %d\n", handle, *((uint32_t*)handle), periods, timeout_us);
+  ((WrappedPulseIn*) handle)->set_window(periods, timeout_us);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, read) (uintptr_t handle, jsmbed_pulse_in_stats_t *stats)
+{
+  ((WrappedPulseIn*) handle)->snapshot(stats, false);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, start)
+    (uintptr_t handle, jerry_object_t *owner, int report_ms, jsmbed_pulse_in_box_t box, jerry_object_t *fptr)
+{
+  LOG_PRINT("[WRAPPER] CALL PulseIn.start 0x%x (0x%x) - %d 0x%x\n", handle, *((uint32_t*)handle), report_ms, fptr);
+  ((WrappedPulseIn*) handle)->start(owner, report_ms, box, fptr);
+  LOG_PRINT("[WRAPPER] CALL-COMPLETE PulseIn.start\n");
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, stop) (uintptr_t handle)
+{
+  LOG_PRINT("[WRAPPER] CALL PulseIn.stop 0x%x (0x%x)\n", handle, *((uint32_t*)handle));
+  ((WrappedPulseIn*) handle)->stop();
+  LOG_PRINT("[WRAPPER] CALL-COMPLETE PulseIn.stop\n");
+}
+
+//
+// - TypedArray ---
+//
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(TypedArray, I_I) (int type, int length)
+{
+  uintptr_t handle = (uintptr_t) new JSTypedArray((TypedArrayType) type, length);
+  LOG_PRINT("[WRAPPER] CREATE TypedArray 0x%x - %d %d\n", handle, type, length);
+  return handle;
+}
+
+int NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, length) (uintptr_t handle)
+{
+  return ((JSTypedArray*) handle)->get_length();
+}
+
+double NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, get) (uintptr_t handle, int index)
+{
+  return ((JSTypedArray*) handle)->get(index);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, set) (uintptr_t handle, int index, double value)
+{
+  ((JSTypedArray*) handle)->set(index, value);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, fill) (uintptr_t handle, double value, int begin, int end)
+{
+  LOG_PRINT("[WRAPPER] CALL TypedArray.fill 0x%x - %f %d %d\n", handle, value, begin, end);
+  ((JSTypedArray*) handle)->fill(value, begin, end);
+}
+
+void NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, copyWithin) (uintptr_t handle, int target, int begin, int end)
+{
+  LOG_PRINT("[WRAPPER] CALL TypedArray.copyWithin 0x%x - %d %d %d\n", handle, target, begin, end);
+  ((JSTypedArray*) handle)->copy_within(target, begin, end);
+}
+
+uintptr_t NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, subarray) (uintptr_t handle, int begin, int end)
+{
+  LOG_PRINT("[WRAPPER] CALL TypedArray.subarray 0x%x - %d %d\n", handle, begin, end);
+  uintptr_t sub_handle = (uintptr_t) new JSTypedArray((JSTypedArray*) handle, begin, end);
+  LOG_PRINT("[WRAPPER] RETURN TypedArray.subarray 0x%x ==> 0x%x\n", handle, sub_handle);
+  return sub_handle;
+}
+
+double NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, sum) (uintptr_t handle)
+{
+  return ((JSTypedArray*) handle)->sum();
+}
+
+double NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, min) (uintptr_t handle)
+{
+  return ((JSTypedArray*) handle)->min();
+}
+
+double NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, max) (uintptr_t handle)
+{
+  return ((JSTypedArray*) handle)->max();
+}
+
+double NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, mean) (uintptr_t handle)
+{
+  return ((JSTypedArray*) handle)->mean();
+}
@@ -19,6 +19,8 @@
 
 #include "jerry-core/jerry.h"
 #include "jsmbed_wrap_name_macros.h"
+#include "jsmbed_wrap_native_link.h"
+#include "jsmbed_wrap_typed_array.h"
 
 // DigitalOut
 uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalOut, I_I) (int pin, int value);
@@ -28,6 +30,59 @@ void NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOut, write) (uintptr_t handle, int va
 int NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOut, read) (uintptr_t handle);
 int NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOut, is_connected) (uintptr_t handle);
 
+// BusOut
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(BusOut, PI_I) (const int *pins, int count);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(BusOut) (uintptr_t handle);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(BusOut, write) (uintptr_t handle, int value);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(BusOut, read) (uintptr_t handle);
+
+// PortOut
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PortOut, I_I) (int port, int mask);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PortOut) (uintptr_t handle);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PortOut, write) (uintptr_t handle, int value);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(PortOut, read) (uintptr_t handle);
+
+// DigitalOutGroup
+#define JSMBED_DIGITAL_OUT_GROUP_MAX_PINS 32
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalOutGroup, PI_I) (const int *pins, int count);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(DigitalOutGroup) (uintptr_t handle);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOutGroup, update) (uintptr_t handle, uint32_t mask, uint32_t value);
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOutGroup, read) (uintptr_t handle);
+
+// DigitalIn
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalIn, I_I) (int pin, int pull);
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalIn, I) (int pin);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(DigitalIn) (uintptr_t handle);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalIn, read) (uintptr_t handle);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalIn, mode) (uintptr_t handle, int pull);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalIn, is_connected) (uintptr_t handle);
+
+// BusIn
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(BusIn, PI_I) (const int *pins, int count);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(BusIn) (uintptr_t handle);
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, read) (uintptr_t handle);
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, changed) (uintptr_t handle);
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, last) (uintptr_t handle);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, mode) (uintptr_t handle, int pull);
+
+// PortIn
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PortIn, I_I) (int port, int mask);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PortIn) (uintptr_t handle);
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, read) (uintptr_t handle);
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, changed) (uintptr_t handle);
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, last) (uintptr_t handle);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, mode) (uintptr_t handle, int pull);
+
+// Asynchronous bus transfers, for I2C and SPI
+
+// At most this many asynchronous transfers can be waiting or in progress.
+#ifndef JSMBED_BUS_ASYNC_QUEUE_SIZE
+#  define JSMBED_BUS_ASYNC_QUEUE_SIZE 4
+#endif
+
+// Called on the event loop with the transfer's result.
+typedef void (*jsmbed_bus_async_complete_t)(void *context, int result);
+
 // I2C
 uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(I2C, I_I) (int sda, int scl);
 void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(I2C) (uintptr_t handle);
@@ -41,6 +96,187 @@ int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I) (uintptr_t handle, int data);
 void NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, start) (uintptr_t handle);
 void NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, stop) (uintptr_t handle);
 
+// Returns false, without queueing anything, if the queue is full. The data
+// must stay alive and untouched until complete has been called.
+bool NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, transfer_async)
+    (uintptr_t handle, bool is_read, int address, char *data, int length, bool repeated,
+     jsmbed_bus_async_complete_t complete, void *context);
+
+// A sequence of transfers, prepared once by the wrapper and then run by
+// I2C.transact in a single call.
+#define JSMBED_I2C_PROGRAM_MAX_OPS 12
+#define JSMBED_I2C_PROGRAM_MAX_BYTES 32
+
+enum jsmbed_i2c_op_code_t {
+  JSMBED_I2C_OP_WRITE,
+  JSMBED_I2C_OP_READ,
+  JSMBED_I2C_OP_DELAY
+};
+
+typedef struct {
+  uint8_t code;
+  bool repeated;
+  int address;
+  char *data;
+  // Bytes to transfer, or microseconds to wait for a delay.
+  int length;
+  // The typed array that data points into, which the program holds a
+  // reference to, or NULL.
+  jerry_object_t *buffer;
+} jsmbed_i2c_op_t;
+
+typedef struct {
+  uint8_t op_count;
+  uint8_t byte_count;
+  jsmbed_i2c_op_t ops[JSMBED_I2C_PROGRAM_MAX_OPS];
+  // Constant data for writes, which the ops point into.
+  char bytes[JSMBED_I2C_PROGRAM_MAX_BYTES];
+  // Links the program to its JS object, which is how it is recognised.
+  jsmbed_wrap_native_link_t link;
+} jsmbed_i2c_program_t;
+
+// Returns 0 once every op has succeeded, or the (1-based) index of the op
+// that failed, in which case the rest are skipped.
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, transact) (uintptr_t handle, const jsmbed_i2c_program_t *program);
+
+// Register access: the register address is written, followed by a repeated
+// start and the read, or by the data in the same transfer. Register values
+// are 8 or 16 bits wide, and big-endian unless little_endian is set. All of
+// these return 0 on success, like I2C.read and I2C.write.
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_registers)
+    (uintptr_t handle, int address, int reg, char *data, int length);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_registers)
+    (uintptr_t handle, int address, int reg, const char *data, int length);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_register)
+    (uintptr_t handle, int address, int reg, int bits, bool little_endian, uint32_t *value);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_register)
+    (uintptr_t handle, int address, int reg, int bits, bool little_endian, uint32_t value);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, update_bits)
+    (uintptr_t handle, int address, int reg, int bits, bool little_endian, uint32_t mask, uint32_t value);
+
+// SPI
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(SPI, I_I_I_I) (int mosi, int miso, int sclk, int ssel);
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(SPI, I_I_I) (int mosi, int miso, int sclk);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(SPI) (uintptr_t handle);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, format) (uintptr_t handle, int bits, int mode);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, frequency) (uintptr_t handle, int hz);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, write) (uintptr_t handle, int value);
+
+// Full-duplex block transfer of up to length bytes, a frame at a time, so
+// frames wider than 8 bits take 2 (or 4) bytes each. tx may be NULL, in which
+// case all ones are sent, and rx may be NULL, or the same buffer as tx.
+// Returns the number of bytes transferred, which only falls short of length
+// when it isn't a whole number of frames.
+int NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, transfer)
+    (uintptr_t handle, const char *tx, char *rx, int length);
+
+// As for I2C.transfer_async. The result is the number of bytes transferred.
+bool NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, transfer_async)
+    (uintptr_t handle, const char *tx, char *rx, int length,
+     jsmbed_bus_async_complete_t complete, void *context);
+
+// Serial
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(Serial, I_I) (int tx, int rx);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Serial) (uintptr_t handle);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, baud) (uintptr_t handle, int rate);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, on_data) (uintptr_t handle, jerry_object_t *fptr);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, set_delimiter) (uintptr_t handle, int delimiter);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, set_threshold) (uintptr_t handle, int threshold);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, set_idle_timeout) (uintptr_t handle, int us);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, available) (uintptr_t handle);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, read) (uintptr_t handle, char *data, int length);
+// Returns -1 if there's no complete line yet.
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, read_line) (uintptr_t handle, char *data, int length);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, write) (uintptr_t handle, const char *data, int length);
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, overflows) (uintptr_t handle);
+// The link to pass to jsmbed_wrap_link_typed_objects.
+jsmbed_wrap_native_link_t *NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, link) (uintptr_t handle);
+
+// Framer
+enum jsmbed_framer_type_t {
+  JSMBED_FRAMER_COBS,
+  JSMBED_FRAMER_SLIP,
+  JSMBED_FRAMER_LENGTH_PREFIXED
+};
+
+typedef struct {
+  uint32_t frames;
+  uint32_t crc_errors;
+  uint32_t framing_errors;
+  uint32_t overflows;
+} jsmbed_framer_stats_t;
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(Framer, I_B) (int type, bool crc);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Framer) (uintptr_t handle);
+// Both return the number of frames waiting to be read.
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, push) (uintptr_t handle, const char *data, int length);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, feed) (uintptr_t handle, uintptr_t serial_handle);
+// Returns the frame's length, which may be more than was copied, or -1.
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, read) (uintptr_t handle, char *data, int length);
+// Returns the encoded length, or -1 if it doesn't fit.
+int NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, encode)
+    (uintptr_t handle, const char *payload, int payload_length, char *out, int out_length);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, stats) (uintptr_t handle, jsmbed_framer_stats_t *stats);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, reset_stats) (uintptr_t handle);
+
+// AnalogIn
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(AnalogIn, I) (int pin);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(AnalogIn) (uintptr_t handle);
+float NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogIn, read) (uintptr_t handle);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogIn, read_u16) (uintptr_t handle);
+
+// AnalogSampler
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(AnalogSampler, I) (int pin);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(AnalogSampler) (uintptr_t handle);
+// Samples every period_us, averaging each group of decimation samples into
+// one value, and alternates between the two blocks of length values. fptr
+// is called with each block object as it fills. The sampler and both blocks
+// are kept alive until stop.
+void NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, start)
+    (uintptr_t handle, jerry_object_t *owner, int period_us, int decimation,
+     jerry_object_t *block_a, uint16_t *data_a, jerry_object_t *block_b, uint16_t *data_b,
+     int length, jerry_object_t *fptr);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, stop) (uintptr_t handle);
+bool NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, running) (uintptr_t handle);
+// Blocks that were dropped, because they filled again before JS had been
+// handed them, or the event loop's mailbox was full.
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, overruns) (uintptr_t handle);
+
+// PwmOut
+enum jsmbed_pwm_curve_t {
+  JSMBED_PWM_CURVE_LINEAR,
+  // Eases in and out (smoothstep).
+  JSMBED_PWM_CURVE_SMOOTH,
+  // Linear in the square root of the duty cycle, so that LED brightness
+  // appears to change evenly.
+  JSMBED_PWM_CURVE_GAMMA
+};
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PwmOut, I) (int pin);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PwmOut) (uintptr_t handle);
+// Changing the output directly stops any ramp or sequence first.
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, period) (uintptr_t handle, float seconds);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, period_us) (uintptr_t handle, int us);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, pulsewidth) (uintptr_t handle, float seconds);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, pulsewidth_us) (uintptr_t handle, int us);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, write) (uintptr_t handle, float duty);
+float NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, read) (uintptr_t handle);
+// Ramps and sequences run from a timer interrupt. fptr may be NULL, and
+// otherwise is called from the event loop when the ramp or sequence ends.
+// Both take over a reference to owner, the JS PwmOut, which is released
+// once the ramp or sequence ends or is stopped.
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, ramp_to)
+    (uintptr_t handle, jerry_object_t *owner, float duty, int ms, int curve, jerry_object_t *fptr);
+// Writes one duty cycle every step_us, from data, which is length floats
+// (0.0 to 1.0) or, if is_u16, uint16_ts (0 to 65535). Also takes over a
+// reference to the sequence object, which keeps data alive while it plays.
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, play_sequence)
+    (uintptr_t handle, jerry_object_t *owner, jerry_object_t *sequence, const void *data, bool is_u16, int length,
+     int step_us, bool loop, jerry_object_t *fptr);
+// Stops a ramp or sequence where it is, without calling back.
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, stop) (uintptr_t handle);
+bool NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, busy) (uintptr_t handle);
+
 // Ticker
 uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(Ticker, _) ();
 void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Ticker) (uintptr_t handle);
@@ -49,12 +285,71 @@ void NAME_FOR_CLASS_NATIVE_FUNCTION(Ticker, attach_us) (uintptr_t handle, jerry_
 void NAME_FOR_CLASS_NATIVE_FUNCTION(Ticker, detach) (uintptr_t handle);
 
 // InterruptIn
+enum jsmbed_interrupt_in_count_t {
+  JSMBED_INTERRUPT_IN_COUNT_NONE = 0,
+  JSMBED_INTERRUPT_IN_COUNT_RISE = 1,
+  JSMBED_INTERRUPT_IN_COUNT_FALL = 2,
+  JSMBED_INTERRUPT_IN_COUNT_BOTH = 3
+};
+
+// Callbacks are called with the us_ticker_read() time of the edge.
 uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(InterruptIn, I) (int pin);
 void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(InterruptIn) (uintptr_t handle);
 void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, rise) (uintptr_t handle, jerry_object_t *fptr);
 void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, fall) (uintptr_t handle, jerry_object_t *fptr);
 void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, mode) (uintptr_t handle, int pull);
+// Filters edges in the ISR, so that only changes of the filtered level
+// are posted. All zero (and samples of 1) turns filtering off.
+void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, debounce)
+    (uintptr_t handle, int debounce_us, int stable_us, int samples);
+// Counts edges (after filtering) natively, whether or not there are callbacks.
+void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, count_edges) (uintptr_t handle, int edges);
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, count) (uintptr_t handle);
+// Returns the count from before it was reset.
+uint32_t NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, reset_count) (uintptr_t handle);
 void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, disable_irq) (uintptr_t handle);
 void NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, enable_irq) (uintptr_t handle);
 
+// PulseIn
+// Averages over the window; pulses counts the periods since the last report.
+// Frequency (in milli-Hz) and duty cycle (in thousandths) are fixed point so
+// that reports box as integers rather than as heap allocated floats.
+typedef struct {
+  uint32_t high_us;
+  uint32_t low_us;
+  uint32_t period_us;
+  uint32_t frequency_mhz;
+  uint32_t duty_permille;
+  uint32_t pulses;
+} jsmbed_pulse_in_stats_t;
+
+// Converts a report to a JS object, on the event loop.
+typedef jerry_object_t *(*jsmbed_pulse_in_box_t)(const jsmbed_pulse_in_stats_t *stats);
+
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PulseIn, I) (int pin);
+void NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PulseIn) (uintptr_t handle);
+// Averages over the last periods measurements, and forgets them once there
+// have been no edges for timeout_us.
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, window) (uintptr_t handle, int periods, int timeout_us);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, read) (uintptr_t handle, jsmbed_pulse_in_stats_t *stats);
+// Calls fptr with box(stats) every report_ms, until stop. The PulseIn is
+// kept alive in the meantime.
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, start)
+    (uintptr_t handle, jerry_object_t *owner, int report_ms, jsmbed_pulse_in_box_t box, jerry_object_t *fptr);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, stop) (uintptr_t handle);
+
+// TypedArray (Uint8Array, Int16Array, Uint16Array, Int32Array, Float32Array)
+// Linked to JS with jsmbed_wrap_link_typed_array, which also frees them.
+uintptr_t NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(TypedArray, I_I) (int type, int length);
+int NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, length) (uintptr_t handle);
+double NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, get) (uintptr_t handle, int index);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, set) (uintptr_t handle, int index, double value);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, fill) (uintptr_t handle, double value, int begin, int end);
+void NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, copyWithin) (uintptr_t handle, int target, int begin, int end);
+uintptr_t NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, subarray) (uintptr_t handle, int begin, int end);
+double NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, sum) (uintptr_t handle);
+double NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, min) (uintptr_t handle);
+double NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, max) (uintptr_t handle);
+double NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, mean) (uintptr_t handle);
+
 #endif
@@ -14,10 +14,102 @@
  * limitations under the License.
  */
 
+#include <limits.h>
+
+#ifdef JMEM_STATS
+#include "jerry-core/jmem/jmem-heap.h"
+#endif
+
+#include "jsmbed_wrap_external_memory.h"
+#include "jsmbed_wrap_function_mailman.h"
+#include "jsmbed_wrap_object_pool.h"
 #include "jsmbed_wrap_tools.h"
 #include "pkgjsmbed_base_native.h"
 #include "pkgjsmbed_base_wrapper.h"
 
+typedef struct {
+  uint32_t capacity;
+  uint32_t in_use;
+  uint32_t peak;
+  uint32_t overflows;
+} pool_stats_t;
+
+DECLARE_JS_SCHEMA_FIELDS(pool_stats_t)
+{
+  JS_SCHEMA_FIELD(pool_stats_t, capacity, UINT32),
+  JS_SCHEMA_FIELD(pool_stats_t, in_use, UINT32),
+  JS_SCHEMA_FIELD(pool_stats_t, peak, UINT32),
+  JS_SCHEMA_FIELD(pool_stats_t, overflows, UINT32)
+};
+DECLARE_JS_SCHEMA(pool_stats_t);
+
+DECLARE_JS_SCHEMA_FIELDS(jsmbed_wrap_profile_entry_t)
+{
+  JS_SCHEMA_FIELD(jsmbed_wrap_profile_entry_t, calls, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_wrap_profile_entry_t, total_us, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_wrap_profile_entry_t, max_us, UINT32)
+};
+DECLARE_JS_SCHEMA(jsmbed_wrap_profile_entry_t);
+
+DECLARE_JS_SCHEMA_FIELDS(jsmbed_wrap_external_memory_stats_t)
+{
+  JS_SCHEMA_FIELD(jsmbed_wrap_external_memory_stats_t, bytes, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_wrap_external_memory_stats_t, peak_bytes, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_wrap_external_memory_stats_t, bytes_since_gc, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_wrap_external_memory_stats_t, threshold, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_wrap_external_memory_stats_t, gc_count, UINT32)
+};
+DECLARE_JS_SCHEMA(jsmbed_wrap_external_memory_stats_t);
+
+DECLARE_JS_SCHEMA_FIELDS(jsmbed_wrap_scratch_stats_t)
+{
+  JS_SCHEMA_FIELD(jsmbed_wrap_scratch_stats_t, allocations, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_wrap_scratch_stats_t, heap_fallbacks, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_wrap_scratch_stats_t, heap_fallback_bytes, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_wrap_scratch_stats_t, high_water_mark, UINT32)
+};
+DECLARE_JS_SCHEMA(jsmbed_wrap_scratch_stats_t);
+
+DECLARE_JS_SCHEMA_FIELDS(jsmbed_framer_stats_t)
+{
+  JS_SCHEMA_FIELD(jsmbed_framer_stats_t, frames, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_framer_stats_t, crc_errors, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_framer_stats_t, framing_errors, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_framer_stats_t, overflows, UINT32)
+};
+DECLARE_JS_SCHEMA(jsmbed_framer_stats_t);
+
+DECLARE_JS_SCHEMA_FIELDS(jsmbed_pulse_in_stats_t)
+{
+  JS_SCHEMA_FIELD(jsmbed_pulse_in_stats_t, high_us, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_pulse_in_stats_t, low_us, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_pulse_in_stats_t, period_us, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_pulse_in_stats_t, frequency_mhz, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_pulse_in_stats_t, duty_permille, UINT32),
+  JS_SCHEMA_FIELD(jsmbed_pulse_in_stats_t, pulses, UINT32)
+};
+DECLARE_JS_SCHEMA(jsmbed_pulse_in_stats_t);
+
+#ifdef JMEM_STATS
+typedef struct {
+  uint32_t size;
+  uint32_t allocated_bytes;
+  uint32_t peak_allocated_bytes;
+  uint32_t alloc_count;
+  uint32_t free_count;
+} heap_stats_t;
+
+DECLARE_JS_SCHEMA_FIELDS(heap_stats_t)
+{
+  JS_SCHEMA_FIELD(heap_stats_t, size, UINT32),
+  JS_SCHEMA_FIELD(heap_stats_t, allocated_bytes, UINT32),
+  JS_SCHEMA_FIELD(heap_stats_t, peak_allocated_bytes, UINT32),
+  JS_SCHEMA_FIELD(heap_stats_t, alloc_count, UINT32),
+  JS_SCHEMA_FIELD(heap_stats_t, free_count, UINT32)
+};
+DECLARE_JS_SCHEMA(heap_stats_t);
+#endif
+
 DECLARE_GLOBAL_FUNCTION(assert)
 {
   CHECK_ARGUMENT_COUNT(global, assert, (args_count == 1));
@@ -39,6 +131,170 @@ DECLARE_GLOBAL_FUNCTION(gc)
   return true;
 }
 
+static void jsmbed_set_uint32_field(jerry_object_t *obj_p, const jsmbed_wrap_key_t *key, uint32_t value)
+{
+  jerry_value_t field_value;
+  jsmbed_wrap_box_uint32(&field_value, value);
+  jsmbed_wrap_set_field(obj_p, key, &field_value);
+}
+
+/*
+ * Returns the occupancy of every native object pool, keyed by pool name, e.g.
+ * { DigitalOut: { capacity: 8, in_use: 4, peak: 4, overflows: 0 }, ... }
+ *
+ * A result from an earlier call can be passed back in to be updated in place.
+ */
+DECLARE_GLOBAL_FUNCTION(pool_stats)
+{
+  CHECK_ARGUMENT_COUNT(global, pool_stats, (args_count <= 1));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(global, pool_stats, 0, object, (args_count == 1));
+
+  jerry_object_t *stats = jsmbed_wrap_result_object(args_p, args_count, 0);
+
+  for (JSObjectPoolBase *pool = JSObjectPoolBase::get_first(); pool != NULL; pool = pool->get_next())
+  {
+    pool_stats_t native_stats;
+    native_stats.capacity = pool->get_capacity();
+    native_stats.in_use = pool->get_in_use();
+    native_stats.peak = pool->get_peak();
+    native_stats.overflows = pool->get_overflows();
+    jsmbed_wrap_fill_object_property(JS_SCHEMA(pool_stats_t), &native_stats, stats, pool->get_name());
+  }
+
+  jsmbed_wrap_box_object(ret_val_p, stats);
+  return true;
+}
+
+/*
+ * Returns the call count and timing of every binding that has been called,
+ * keyed by "Class.name", e.g.
+ * { "DigitalOut.write": { calls: 120, total_us: 960, max_us: 12 }, ... }
+ *
+ * Bindings are only profiled when built with JSMBED_PROFILE_BINDINGS, so
+ * otherwise this is always empty. As with pool_stats, an earlier result can be
+ * passed back in to be updated in place.
+ */
+DECLARE_GLOBAL_FUNCTION(binding_stats)
+{
+  CHECK_ARGUMENT_COUNT(global, binding_stats, (args_count <= 1));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(global, binding_stats, 0, object, (args_count == 1));
+
+  jerry_object_t *stats = jsmbed_wrap_result_object(args_p, args_count, 0);
+
+  for (jsmbed_wrap_profile_entry_t *entry = jsmbed_wrap_profile_get_first(); entry != NULL; entry = entry->next)
+  {
+    char name[64];
+    snprintf(name, sizeof(name), "%s.%s", entry->class_name, entry->name);
+    jsmbed_wrap_fill_object_property(JS_SCHEMA(jsmbed_wrap_profile_entry_t), entry, stats, name);
+  }
+
+  jsmbed_wrap_box_object(ret_val_p, stats);
+  return true;
+}
+
+#ifdef JMEM_STATS
+/*
+ * Returns the JerryScript heap usage, e.g.
+ * { size: 16384, allocated_bytes: 5120, peak_allocated_bytes: 6144, alloc_count: 900, free_count: 850 }
+ *
+ * Only available when the engine library is built with memory statistics and
+ * JMEM_STATS is defined. The result object can be passed back in to be
+ * updated in place, so that checking the heap doesn't itself allocate.
+ */
+DECLARE_GLOBAL_FUNCTION(heap_stats)
+{
+  CHECK_ARGUMENT_COUNT(global, heap_stats, (args_count <= 1));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(global, heap_stats, 0, object, (args_count == 1));
+
+  jmem_heap_stats_t engine_stats;
+  jmem_heap_get_stats(&engine_stats);
+
+  heap_stats_t native_stats;
+  native_stats.size = engine_stats.size;
+  native_stats.allocated_bytes = engine_stats.allocated_bytes;
+  native_stats.peak_allocated_bytes = engine_stats.peak_allocated_bytes;
+  native_stats.alloc_count = engine_stats.alloc_count;
+  native_stats.free_count = engine_stats.free_count;
+
+  jerry_object_t *stats = jsmbed_wrap_result_object(args_p, args_count, 0);
+  jsmbed_wrap_fill_object(JS_SCHEMA(heap_stats_t), &native_stats, stats);
+
+  jsmbed_wrap_box_object(ret_val_p, stats);
+  return true;
+}
+#endif
+
+/*
+ * Returns how much native memory JS objects are holding, e.g.
+ * { bytes: 1200, peak_bytes: 2400, bytes_since_gc: 300, threshold: 2048, gc_count: 3 }
+ *
+ * The result object can be passed back in to be updated in place.
+ */
+DECLARE_GLOBAL_FUNCTION(external_memory)
+{
+  CHECK_ARGUMENT_COUNT(global, external_memory, (args_count <= 1));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(global, external_memory, 0, object, (args_count == 1));
+
+  jsmbed_wrap_external_memory_stats_t native_stats;
+  jsmbed_wrap_external_memory_get_stats(&native_stats);
+
+  jerry_object_t *stats = jsmbed_wrap_result_object(args_p, args_count, 0);
+  jsmbed_wrap_fill_object(JS_SCHEMA(jsmbed_wrap_external_memory_stats_t), &native_stats, stats);
+
+  jsmbed_wrap_box_object(ret_val_p, stats);
+  return true;
+}
+
+/*
+ * Returns how the scratch arena that bindings allocate temporaries from is
+ * being used, e.g.
+ * { allocations: 400, heap_fallbacks: 2, heap_fallback_bytes: 1024, high_water_mark: 380 }
+ *
+ * Heap fallbacks, or a high-water mark close to JSMBED_SCRATCH_ARENA_SIZE,
+ * mean the arena is too small. The result object can be passed back in to
+ * be updated in place.
+ */
+DECLARE_GLOBAL_FUNCTION(scratch_stats)
+{
+  CHECK_ARGUMENT_COUNT(global, scratch_stats, (args_count <= 1));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(global, scratch_stats, 0, object, (args_count == 1));
+
+  jsmbed_wrap_scratch_stats_t native_stats;
+  jsmbed_wrap_scratch_get_stats(&native_stats);
+
+  jerry_object_t *stats = jsmbed_wrap_result_object(args_p, args_count, 0);
+  jsmbed_wrap_fill_object(JS_SCHEMA(jsmbed_wrap_scratch_stats_t), &native_stats, stats);
+
+  jsmbed_wrap_box_object(ret_val_p, stats);
+  return true;
+}
+
+// Sets how much native memory can be allocated before the GC is run (0 to never run it).
+DECLARE_GLOBAL_FUNCTION(set_external_memory_threshold)
+{
+  CHECK_ARGUMENT_COUNT(global, set_external_memory_threshold, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(global, set_external_memory_threshold, 0, number);
+
+  jsmbed_wrap_external_memory_set_threshold(jsmbed_wrap_unbox_number(&args_p[0]));
+  return true;
+}
+
+DECLARE_GLOBAL_FUNCTION(print_binding_stats)
+{
+  CHECK_ARGUMENT_COUNT(global, print_binding_stats, (args_count == 0));
+
+  jsmbed_wrap_profile_print();
+  return true;
+}
+
+DECLARE_GLOBAL_FUNCTION(reset_binding_stats)
+{
+  CHECK_ARGUMENT_COUNT(global, reset_binding_stats, (args_count == 0));
+
+  jsmbed_wrap_profile_reset();
+  return true;
+}
+
 //
 // DigitalOut
 //
@@ -89,6 +345,10 @@ DECLARE_CLASS_CONSTRUCTOR(DigitalOut)
     int value = jsmbed_wrap_unbox_number(&args_p[1]);
     native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalOut, I_I) (pin, value);
   }
+  if (native_handle == 0)
+  {
+    return false;
+  }
 
   jerry_object_t *js_object = jsmbed_wrap_create_object();
   jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(DigitalOut));
@@ -100,285 +360,2782 @@ DECLARE_CLASS_CONSTRUCTOR(DigitalOut)
   return true;
 }
 
-//
-// I2C
-//
-DECLARE_CLASS_FUNCTION(I2C, frequency)
-{
-  CHECK_ARGUMENT_COUNT(Ticker, frequency, (args_count == 1));
-  CHECK_ARGUMENT_TYPE_ALWAYS(Ticker, frequency, 0, number);
-  int hz = jsmbed_wrap_unbox_number(&args_p[0]);
-  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, frequency)(native_handle, hz);
-  return true;
-}
-
-DECLARE_CLASS_FUNCTION(I2C, read)
+/*
+ * Collects pins passed either as separate arguments, e.g. BusOut(LED1, LED2),
+ * or as a single array, e.g. BusOut([LED1, LED2]). Returns how many there
+ * are, or -1 (having printed why) if they aren't all pins or there are more
+ * than max_pins.
+ */
+static int jsmbed_unbox_pin_list(const char *class_name,
+                                 const jerry_value_t args_p[],
+                                 jerry_length_t args_count,
+                                 int pins[],
+                                 int max_pins)
 {
-  if (args_count == 1)
+  if (args_count == 1 && jsmbed_wrap_value_is_object(&args_p[0]))
   {
-    CHECK_ARGUMENT_TYPE_ALWAYS(I2C, read, 0, number);
-    uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-    int data = jsmbed_wrap_unbox_number(&args_p[0]);
-    int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_I)(native_handle, data);
-    jsmbed_wrap_box_uint32(ret_val_p, result);
-    return true;
-  }
-  else if (args_count == 3 || args_count == 4)
-  {
-    CHECK_ARGUMENT_TYPE_ALWAYS(I2C, read, 0, number);
-    CHECK_ARGUMENT_TYPE_ALWAYS(I2C, read, 1, object);
-    CHECK_ARGUMENT_TYPE_ALWAYS(I2C, read, 2, number);
-    CHECK_ARGUMENT_TYPE_ON_CONDITION(I2C, read, 3, boolean, (args_count == 4));
-    uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-    int address = jsmbed_wrap_unbox_number(&args_p[0]);
-    char *data = jsmbed_wrap_alloc_same_sized_char_array(&args_p[1]);
-    int length = jsmbed_wrap_unbox_number(&args_p[2]);
-    bool repeated = false;
-    if (args_count == 4)
+    int count = jsmbed_wrap_get_array_length(&args_p[0]);
+    if (count > max_pins)
     {
-      repeated = jsmbed_wrap_unbox_boolean(&args_p[3]);
+      printf("ERROR: %s takes at most %d pins, but was given %d.\n", class_name, max_pins, count);
+      return -1;
     }
 
-    int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_I_PC_I_B)
-        (native_handle, address, data, length, repeated);
-    jsmbed_wrap_box_uint32(ret_val_p, result);
-
-    // Have to cast because we are intentionally modifying this argument.
-    jsmbed_wrap_copy_char_array_to_js_array((jerry_value_t*) &args_p[1], data);
-
-    jsmbed_wrap_delete_char_array(data);
+    jerry_object_t *array_object = jsmbed_wrap_unbox_object(&args_p[0]);
+    for (int index = 0; index < count; index++)
+    {
+      jerry_value_t pin_value;
+      jerry_get_array_index_value(array_object, index, &pin_value);
+      bool is_pin = jsmbed_wrap_value_is_number(&pin_value);
+      if (is_pin)
+      {
+        pins[index] = jsmbed_wrap_unbox_number(&pin_value);
+      }
+      jerry_release_value(&pin_value);
 
-    return true;
+      if (!is_pin)
+      {
+        printf("ERROR: wrong pin type for %s, expected pin %d to be a number.\n", class_name, index);
+        return -1;
+      }
+    }
+    return count;
   }
-  printf("ERROR: Unexpected number of arguments to I2C.read, expected 1, 3 or 4.");
-  return false;
-}
 
-DECLARE_CLASS_FUNCTION(I2C, write)
-{
-  if (args_count == 1)
+  if ((int) args_count > max_pins)
   {
-    CHECK_ARGUMENT_TYPE_ALWAYS(I2C, write, 0, number);
-    uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-    int data = jsmbed_wrap_unbox_number(&args_p[0]);
-    int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I)(native_handle, data);
-    jsmbed_wrap_box_uint32(ret_val_p, result);
-    return true;
+    printf("ERROR: %s takes at most %d pins, but was given %d.\n", class_name, max_pins, (int) args_count);
+    return -1;
   }
-  else if (args_count == 3 || args_count == 4)
+
+  for (jerry_length_t index = 0; index < args_count; index++)
   {
-    CHECK_ARGUMENT_TYPE_ALWAYS(I2C, write, 0, number);
-    CHECK_ARGUMENT_TYPE_ALWAYS(I2C, write, 1, object);
-    CHECK_ARGUMENT_TYPE_ALWAYS(I2C, write, 2, number);
-    CHECK_ARGUMENT_TYPE_ON_CONDITION(I2C, write, 3, boolean, (args_count == 4));
-    uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-    int address = jsmbed_wrap_unbox_number(&args_p[0]);
-    char *data = jsmbed_wrap_alloc_same_sized_char_array(&args_p[1]);
-    jsmbed_wrap_copy_char_array_from_js_array(data, &args_p[1]);
-    int length = jsmbed_wrap_unbox_number(&args_p[2]);
-    bool repeated = false;
-    if (args_count == 4)
+    if (!jsmbed_wrap_value_is_number(&args_p[index]))
     {
-      repeated = jsmbed_wrap_unbox_boolean(&args_p[3]);
+      printf("ERROR: wrong argument type for %s, expected argument %d to be a pin.\n", class_name, (int) index);
+      return -1;
     }
-
-    int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I_KPC_I_B)
-        (native_handle, address, (const char*) data, length, repeated);
-    jsmbed_wrap_box_uint32(ret_val_p, result);
-
-    jsmbed_wrap_delete_char_array(data);
-
-    return true;
+    pins[index] = jsmbed_wrap_unbox_number(&args_p[index]);
   }
-  printf("ERROR: Unexpected number of arguments to I2C.write, expected 1, 3 or 4.");
-  return false;
+  return args_count;
 }
 
-DECLARE_CLASS_FUNCTION(I2C, start)
+// Bit masks may arrive as negative numbers, since JS bitwise operators
+// produce signed 32-bit results (e.g. 1 << 31).
+static uint32_t jsmbed_unbox_bits(const jerry_value_t *val_p)
 {
-  CHECK_ARGUMENT_COUNT(I2C, start, (args_count == 0));
+  return (uint32_t) (int64_t) jsmbed_wrap_unbox_number(val_p);
+}
+
+//
+// BusOut
+//
+DECLARE_CLASS_FUNCTION(BusOut, write)
+{
+  CHECK_ARGUMENT_COUNT(BusOut, write, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(BusOut, write, 0, number);
+  int value = jsmbed_unbox_bits(&args_p[0]);
   uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, start)(native_handle);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(BusOut, write)(native_handle, value);
   return true;
 }
 
-DECLARE_CLASS_FUNCTION(I2C, stop)
+DECLARE_CLASS_FUNCTION(BusOut, read)
 {
-  CHECK_ARGUMENT_COUNT(I2C, stop, (args_count == 0));
+  CHECK_ARGUMENT_COUNT(BusOut, read, (args_count == 0));
   uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, stop)(native_handle);
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(BusOut, read)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
   return true;
 }
 
-DECLARE_CLASS_CONSTRUCTOR(I2C)
+DECLARE_CLASS_CONSTRUCTOR(BusOut)
 {
-  CHECK_ARGUMENT_COUNT(I2C, __constructor, (args_count == 2));
-  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, __constructor, 0, number);
-  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, __constructor, 1, number);
+  CHECK_ARGUMENT_COUNT(BusOut, __constructor, (args_count >= 1));
 
-  int sda = jsmbed_wrap_unbox_number(&args_p[0]);
-  int scl = jsmbed_wrap_unbox_number(&args_p[1]);
+  int pins[16];
+  int count = jsmbed_unbox_pin_list("BusOut", args_p, args_count, pins, 16);
+  if (count < 0)
+  {
+    return false;
+  }
 
-  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(I2C, I_I) (sda, scl);
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(BusOut, PI_I) (pins, count);
+  if (native_handle == 0)
+  {
+    return false;
+  }
 
   jerry_object_t *js_object = jsmbed_wrap_create_object();
-  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(I2C));
-  ATTACH_CLASS_FUNCTION(js_object, I2C, frequency);
-  ATTACH_CLASS_FUNCTION(js_object, I2C, read);
-  ATTACH_CLASS_FUNCTION(js_object, I2C, write);
-  ATTACH_CLASS_FUNCTION(js_object, I2C, start);
-  ATTACH_CLASS_FUNCTION(js_object, I2C, stop);
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(BusOut));
+  ATTACH_CLASS_FUNCTION(js_object, BusOut, write);
+  ATTACH_CLASS_FUNCTION(js_object, BusOut, read);
 
   jsmbed_wrap_box_object(ret_val_p, js_object);
   return true;
 }
 
 //
-// Ticker
+// PortOut
 //
-DECLARE_CLASS_FUNCTION(Ticker, attach)
-{
-  CHECK_ARGUMENT_COUNT(Ticker, attach, (args_count == 2));
-  CHECK_ARGUMENT_TYPE_ALWAYS(Ticker, attach, 0, function);
-  CHECK_ARGUMENT_TYPE_ALWAYS(Ticker, attach, 1, number);
-  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  jerry_object_t *fptr = jsmbed_wrap_unbox_object(&args_p[0]);
-  jsmbed_wrap_acquire_object(fptr);
-  float t = jsmbed_wrap_unbox_number(&args_p[1]);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(Ticker, attach) (native_handle, fptr, t);
-  return true;
-}
-
-DECLARE_CLASS_FUNCTION(Ticker, attach_us)
+DECLARE_CLASS_FUNCTION(PortOut, write)
 {
-  CHECK_ARGUMENT_COUNT(Ticker, attach_us, (args_count == 2));
-  CHECK_ARGUMENT_TYPE_ALWAYS(Ticker, attach_us, 0, function);
-  CHECK_ARGUMENT_TYPE_ALWAYS(Ticker, attach_us, 1, number);
+  CHECK_ARGUMENT_COUNT(PortOut, write, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PortOut, write, 0, number);
+  int value = jsmbed_unbox_bits(&args_p[0]);
   uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  jerry_object_t *fptr = jsmbed_wrap_unbox_object(&args_p[0]);
-  jsmbed_wrap_acquire_object(fptr);
-  int t = jsmbed_wrap_unbox_number(&args_p[1]);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(Ticker, attach_us) (native_handle, fptr, t);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PortOut, write)(native_handle, value);
   return true;
 }
 
-DECLARE_CLASS_FUNCTION(Ticker, detach)
+DECLARE_CLASS_FUNCTION(PortOut, read)
 {
-  CHECK_ARGUMENT_COUNT(Ticker, detach, (args_count == 0));
+  CHECK_ARGUMENT_COUNT(PortOut, read, (args_count == 0));
   uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(Ticker, detach)(native_handle);
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(PortOut, read)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
   return true;
 }
 
-DECLARE_CLASS_CONSTRUCTOR(Ticker)
+DECLARE_CLASS_CONSTRUCTOR(PortOut)
 {
-  CHECK_ARGUMENT_COUNT(Ticker, __constructor, (args_count == 0));
+  CHECK_ARGUMENT_COUNT(PortOut, __constructor, (args_count == 1 || args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PortOut, __constructor, 0, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(PortOut, __constructor, 1, number, (args_count == 2));
 
-  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(Ticker, _) ();
+  int port = jsmbed_wrap_unbox_number(&args_p[0]);
+  int mask = (args_count == 2) ? jsmbed_unbox_bits(&args_p[1]) : 0xFFFFFFFF;
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PortOut, I_I) (port, mask);
+  if (native_handle == 0)
+  {
+    return false;
+  }
 
   jerry_object_t *js_object = jsmbed_wrap_create_object();
-  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Ticker));
-  ATTACH_CLASS_FUNCTION(js_object, Ticker, attach);
-  ATTACH_CLASS_FUNCTION(js_object, Ticker, attach_us);
-  ATTACH_CLASS_FUNCTION(js_object, Ticker, detach);
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PortOut));
+  ATTACH_CLASS_FUNCTION(js_object, PortOut, write);
+  ATTACH_CLASS_FUNCTION(js_object, PortOut, read);
 
   jsmbed_wrap_box_object(ret_val_p, js_object);
   return true;
 }
 
 //
-// InterruptIn
+// DigitalOutGroup
 //
-DECLARE_CLASS_FUNCTION(InterruptIn, rise)
+DECLARE_CLASS_FUNCTION(DigitalOutGroup, write)
 {
-  CHECK_ARGUMENT_COUNT(InterruptIn, rise, (args_count == 1));
-  // Special case for rise(null), which means "detach the rise callback"
-  if (jsmbed_wrap_value_is_null(&args_p[1]))
-  {
-    uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-    NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, rise) (native_handle, NULL);
-    return true;
-  }
-
-  // Assuming we actually have a callback now...
-  CHECK_ARGUMENT_TYPE_ALWAYS(InterruptIn, rise, 0, function);
+  CHECK_ARGUMENT_COUNT(DigitalOutGroup, write, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(DigitalOutGroup, write, 0, number);
+  uint32_t value = jsmbed_unbox_bits(&args_p[0]);
   uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  jerry_object_t *fptr = jsmbed_wrap_unbox_object(&args_p[0]);
-  jsmbed_wrap_acquire_object(fptr);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, rise) (native_handle, fptr);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOutGroup, update)(native_handle, 0xFFFFFFFF, value);
   return true;
 }
 
-DECLARE_CLASS_FUNCTION(InterruptIn, fall)
+// Writes only the pins selected by mask.
+DECLARE_CLASS_FUNCTION(DigitalOutGroup, update)
 {
-  CHECK_ARGUMENT_COUNT(InterruptIn, fall, (args_count == 1));
-  // Special case for fall(null), which means "detach the fall callback"
-  if (jsmbed_wrap_value_is_null(&args_p[1]))
-  {
-    uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-    NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, fall) (native_handle, NULL);
-    return true;
-  }
-
-  // Assuming we actually have a callback now...
-  CHECK_ARGUMENT_TYPE_ALWAYS(InterruptIn, fall, 0, function);
+  CHECK_ARGUMENT_COUNT(DigitalOutGroup, update, (args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(DigitalOutGroup, update, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(DigitalOutGroup, update, 1, number);
+  uint32_t mask = jsmbed_unbox_bits(&args_p[0]);
+  uint32_t value = jsmbed_unbox_bits(&args_p[1]);
   uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  jerry_object_t *fptr = jsmbed_wrap_unbox_object(&args_p[0]);
-  jsmbed_wrap_acquire_object(fptr);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, fall) (native_handle, fptr);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOutGroup, update)(native_handle, mask, value);
   return true;
 }
 
-DECLARE_CLASS_FUNCTION(InterruptIn, mode)
+DECLARE_CLASS_FUNCTION(DigitalOutGroup, set)
 {
-  CHECK_ARGUMENT_COUNT(InterruptIn, mode, (args_count == 1));
-  CHECK_ARGUMENT_TYPE_ALWAYS(InterruptIn, mode, 0, number);
+  CHECK_ARGUMENT_COUNT(DigitalOutGroup, set, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(DigitalOutGroup, set, 0, number);
+  uint32_t mask = jsmbed_unbox_bits(&args_p[0]);
   uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  int pull = jsmbed_wrap_unbox_number(&args_p[0]);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, mode) (native_handle, pull);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOutGroup, update)(native_handle, mask, 0xFFFFFFFF);
   return true;
 }
 
-DECLARE_CLASS_FUNCTION(InterruptIn, disable_irq)
+DECLARE_CLASS_FUNCTION(DigitalOutGroup, clear)
 {
-  CHECK_ARGUMENT_COUNT(InterruptIn, disable_irq, (args_count == 0));
+  CHECK_ARGUMENT_COUNT(DigitalOutGroup, clear, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(DigitalOutGroup, clear, 0, number);
+  uint32_t mask = jsmbed_unbox_bits(&args_p[0]);
   uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, disable_irq) (native_handle);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOutGroup, update)(native_handle, mask, 0);
   return true;
 }
 
-DECLARE_CLASS_FUNCTION(InterruptIn, enable_irq)
+DECLARE_CLASS_FUNCTION(DigitalOutGroup, read)
 {
-  CHECK_ARGUMENT_COUNT(InterruptIn, enable_irq, (args_count == 0));
+  CHECK_ARGUMENT_COUNT(DigitalOutGroup, read, (args_count == 0));
   uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
-  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, enable_irq) (native_handle);
+  uint32_t result = NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalOutGroup, read)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
   return true;
 }
 
-DECLARE_CLASS_CONSTRUCTOR(InterruptIn)
+DECLARE_CLASS_CONSTRUCTOR(DigitalOutGroup)
 {
-  CHECK_ARGUMENT_COUNT(InterruptIn, __constructor, (args_count == 1));
-  CHECK_ARGUMENT_TYPE_ALWAYS(InterruptIn, __constructor, 0, number);
-  int pin = jsmbed_wrap_unbox_number(&args_p[0]);
-  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(InterruptIn, I) (pin);
-  jerry_object_t *js_object = jsmbed_wrap_create_object();
-  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(InterruptIn));
-  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, rise);
-  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, fall);
-  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, mode);
-  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, enable_irq);
-  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, disable_irq);
-  jsmbed_wrap_box_object(ret_val_p, js_object);
-  return true;
-}
+  CHECK_ARGUMENT_COUNT(DigitalOutGroup, __constructor, (args_count >= 1));
+
+  int pins[JSMBED_DIGITAL_OUT_GROUP_MAX_PINS];
+  int count = jsmbed_unbox_pin_list("DigitalOutGroup", args_p, args_count, pins, JSMBED_DIGITAL_OUT_GROUP_MAX_PINS);
+  if (count < 0)
+  {
+    return false;
+  }
+
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalOutGroup, PI_I) (pins, count);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(DigitalOutGroup));
+  jsmbed_set_uint32_field(js_object, JS_KEY(length), count);
+  ATTACH_CLASS_FUNCTION(js_object, DigitalOutGroup, write);
+  ATTACH_CLASS_FUNCTION(js_object, DigitalOutGroup, update);
+  ATTACH_CLASS_FUNCTION(js_object, DigitalOutGroup, set);
+  ATTACH_CLASS_FUNCTION(js_object, DigitalOutGroup, clear);
+  ATTACH_CLASS_FUNCTION(js_object, DigitalOutGroup, read);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// DigitalIn
+//
+DECLARE_CLASS_FUNCTION(DigitalIn, read)
+{
+  CHECK_ARGUMENT_COUNT(DigitalIn, read, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalIn, read)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(DigitalIn, mode)
+{
+  CHECK_ARGUMENT_COUNT(DigitalIn, mode, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(DigitalIn, mode, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int pull = jsmbed_wrap_unbox_number(&args_p[0]);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalIn, mode) (native_handle, pull);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(DigitalIn, is_connected)
+{
+  CHECK_ARGUMENT_COUNT(DigitalIn, is_connected, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(DigitalIn, is_connected)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(DigitalIn)
+{
+  CHECK_ARGUMENT_COUNT(DigitalIn, __constructor, (args_count == 1 || args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(DigitalIn, __constructor, 0, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(DigitalIn, __constructor, 1, number, (args_count == 2));
+
+  int pin = jsmbed_wrap_unbox_number(&args_p[0]);
+  uintptr_t native_handle;
+
+  if (args_count == 1)
+  {
+    native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalIn, I) (pin);
+  }
+  else
+  {
+    int pull = jsmbed_wrap_unbox_number(&args_p[1]);
+    native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(DigitalIn, I_I) (pin, pull);
+  }
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(DigitalIn));
+  ATTACH_CLASS_FUNCTION(js_object, DigitalIn, read);
+  ATTACH_CLASS_FUNCTION(js_object, DigitalIn, mode);
+  ATTACH_CLASS_FUNCTION(js_object, DigitalIn, is_connected);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// BusIn
+//
+DECLARE_CLASS_FUNCTION(BusIn, read)
+{
+  CHECK_ARGUMENT_COUNT(BusIn, read, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  uint32_t result = NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, read)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+// Returns the bits that differ from the previous read() or changed(), and
+// remembers the new value, which last() then returns without reading again.
+DECLARE_CLASS_FUNCTION(BusIn, changed)
+{
+  CHECK_ARGUMENT_COUNT(BusIn, changed, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  uint32_t result = NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, changed)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(BusIn, last)
+{
+  CHECK_ARGUMENT_COUNT(BusIn, last, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  uint32_t result = NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, last)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(BusIn, mode)
+{
+  CHECK_ARGUMENT_COUNT(BusIn, mode, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(BusIn, mode, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int pull = jsmbed_wrap_unbox_number(&args_p[0]);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(BusIn, mode) (native_handle, pull);
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(BusIn)
+{
+  CHECK_ARGUMENT_COUNT(BusIn, __constructor, (args_count >= 1));
+
+  int pins[16];
+  int count = jsmbed_unbox_pin_list("BusIn", args_p, args_count, pins, 16);
+  if (count < 0)
+  {
+    return false;
+  }
+
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(BusIn, PI_I) (pins, count);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(BusIn));
+  ATTACH_CLASS_FUNCTION(js_object, BusIn, read);
+  ATTACH_CLASS_FUNCTION(js_object, BusIn, changed);
+  ATTACH_CLASS_FUNCTION(js_object, BusIn, last);
+  ATTACH_CLASS_FUNCTION(js_object, BusIn, mode);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// PortIn
+//
+DECLARE_CLASS_FUNCTION(PortIn, read)
+{
+  CHECK_ARGUMENT_COUNT(PortIn, read, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  uint32_t result = NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, read)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+// As BusIn.changed.
+DECLARE_CLASS_FUNCTION(PortIn, changed)
+{
+  CHECK_ARGUMENT_COUNT(PortIn, changed, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  uint32_t result = NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, changed)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(PortIn, last)
+{
+  CHECK_ARGUMENT_COUNT(PortIn, last, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  uint32_t result = NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, last)(native_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(PortIn, mode)
+{
+  CHECK_ARGUMENT_COUNT(PortIn, mode, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PortIn, mode, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int pull = jsmbed_wrap_unbox_number(&args_p[0]);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PortIn, mode) (native_handle, pull);
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(PortIn)
+{
+  CHECK_ARGUMENT_COUNT(PortIn, __constructor, (args_count == 1 || args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PortIn, __constructor, 0, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(PortIn, __constructor, 1, number, (args_count == 2));
+
+  int port = jsmbed_wrap_unbox_number(&args_p[0]);
+  int mask = (args_count == 2) ? jsmbed_unbox_bits(&args_p[1]) : 0xFFFFFFFF;
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PortIn, I_I) (port, mask);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PortIn));
+  ATTACH_CLASS_FUNCTION(js_object, PortIn, read);
+  ATTACH_CLASS_FUNCTION(js_object, PortIn, changed);
+  ATTACH_CLASS_FUNCTION(js_object, PortIn, last);
+  ATTACH_CLASS_FUNCTION(js_object, PortIn, mode);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// I2C
+//
+DECLARE_CLASS_FUNCTION(I2C, frequency)
+{
+  CHECK_ARGUMENT_COUNT(Ticker, frequency, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(Ticker, frequency, 0, number);
+  int hz = jsmbed_wrap_unbox_number(&args_p[0]);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, frequency)(native_handle, hz);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, read, I)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int data = jsmbed_wrap_unbox_number(&args_p[0]);
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_I)(native_handle, data);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+// Typed arrays are read into directly, without any copying.
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, read, I_TA_I_B)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[1]);
+  int length = jsmbed_wrap_unbox_number(&args_p[2]);
+  bool repeated = (args_count == 4) ? jsmbed_wrap_unbox_boolean(&args_p[3]) : false;
+
+  if (length < 0 || (uint32_t) length > data->get_byte_length())
+  {
+    printf("ERROR: I2C.read length %d is larger than the typed array passed in.\n", length);
+    return false;
+  }
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_I_PC_I_B)
+      (native_handle, address, (char*) data->get_data(), length, repeated);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+// Reads the whole typed array, so the length doesn't have to be passed.
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, read, I_TA_B)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[1]);
+  bool repeated = (args_count == 3) ? jsmbed_wrap_unbox_boolean(&args_p[2]) : false;
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_I_PC_I_B)
+      (native_handle, address, (char*) data->get_data(), data->get_byte_length(), repeated);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, read, I_PC_I_B)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  int length = jsmbed_wrap_unbox_number(&args_p[2]);
+  bool repeated = (args_count == 4) ? jsmbed_wrap_unbox_boolean(&args_p[3]) : false;
+
+  // The scratch buffer is the same size as the array, so this bounds both.
+  if (length < 0 || length > jsmbed_wrap_get_array_length(&args_p[1]))
+  {
+    printf("ERROR: I2C.read length %d is larger than the array passed in.\n", length);
+    return false;
+  }
+
+  char *data = jsmbed_wrap_scratch_alloc_same_sized_char_array(&args_p[1]);
+  if (data == NULL)
+  {
+    printf("ERROR: Out of memory in I2C.read.\n");
+    return false;
+  }
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_I_PC_I_B)
+      (native_handle, address, data, length, repeated);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+
+  // Have to cast because we are intentionally modifying this argument.
+  jsmbed_wrap_copy_char_array_to_js_array((jerry_value_t*) &args_p[1], data);
+
+  jsmbed_wrap_scratch_free(data);
+
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOADS(I2C, read)
+{
+  CLASS_FUNCTION_OVERLOAD(I2C, read, I, "n"),
+  CLASS_FUNCTION_OVERLOAD(I2C, read, I_TA_I_B, "ntn|b"),
+  CLASS_FUNCTION_OVERLOAD(I2C, read, I_TA_B, "nt|b"),
+  CLASS_FUNCTION_OVERLOAD(I2C, read, I_PC_I_B, "non|b")
+};
+
+DISPATCH_CLASS_FUNCTION_OVERLOADS(I2C, read)
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, write, I)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int data = jsmbed_wrap_unbox_number(&args_p[0]);
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I)(native_handle, data);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+// Typed arrays are written from directly, without any copying.
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, write, I_TA_I_B)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[1]);
+  int length = jsmbed_wrap_unbox_number(&args_p[2]);
+  bool repeated = (args_count == 4) ? jsmbed_wrap_unbox_boolean(&args_p[3]) : false;
+
+  if (length < 0 || (uint32_t) length > data->get_byte_length())
+  {
+    printf("ERROR: I2C.write length %d is larger than the typed array passed in.\n", length);
+    return false;
+  }
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I_KPC_I_B)
+      (native_handle, address, (const char*) data->get_data(), length, repeated);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+// Writes the whole typed array, so the length doesn't have to be passed.
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, write, I_TA_B)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[1]);
+  bool repeated = (args_count == 3) ? jsmbed_wrap_unbox_boolean(&args_p[2]) : false;
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I_KPC_I_B)
+      (native_handle, address, (const char*) data->get_data(), data->get_byte_length(), repeated);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, write, I_KPC_I_B)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  int length = jsmbed_wrap_unbox_number(&args_p[2]);
+  bool repeated = (args_count == 4) ? jsmbed_wrap_unbox_boolean(&args_p[3]) : false;
+
+  // The scratch buffer is the same size as the array, so this bounds both.
+  if (length < 0 || length > jsmbed_wrap_get_array_length(&args_p[1]))
+  {
+    printf("ERROR: I2C.write length %d is larger than the array passed in.\n", length);
+    return false;
+  }
+
+  char *data = jsmbed_wrap_scratch_alloc_same_sized_char_array(&args_p[1]);
+  if (data == NULL)
+  {
+    printf("ERROR: Out of memory in I2C.write.\n");
+    return false;
+  }
+  jsmbed_wrap_copy_char_array_from_js_array(data, &args_p[1]);
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_I_KPC_I_B)
+      (native_handle, address, (const char*) data, length, repeated);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+
+  jsmbed_wrap_scratch_free(data);
+
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOADS(I2C, write)
+{
+  CLASS_FUNCTION_OVERLOAD(I2C, write, I, "n"),
+  CLASS_FUNCTION_OVERLOAD(I2C, write, I_TA_I_B, "ntn|b"),
+  CLASS_FUNCTION_OVERLOAD(I2C, write, I_TA_B, "nt|b"),
+  CLASS_FUNCTION_OVERLOAD(I2C, write, I_KPC_I_B, "non|b")
+};
+
+DISPATCH_CLASS_FUNCTION_OVERLOADS(I2C, write)
+
+DECLARE_CLASS_FUNCTION(I2C, start)
+{
+  CHECK_ARGUMENT_COUNT(I2C, start, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, start)(native_handle);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(I2C, stop)
+{
+  CHECK_ARGUMENT_COUNT(I2C, stop, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, stop)(native_handle);
+  return true;
+}
+
+// Keeps the bus object, its buffers and the callback alive until an
+// asynchronous transfer has finished with them.
+class BusAsyncTransfer
+{
+public:
+  BusAsyncTransfer(jerry_object_t *bus_object, jerry_object_t *tx_object, jerry_object_t *rx_object, jerry_object_t *callback) :
+    bus_object(bus_object),
+    tx_object(tx_object),
+    rx_object(rx_object)
+  {
+    jsmbed_wrap_acquire_object(bus_object);
+    if (tx_object != NULL)
+    {
+      jsmbed_wrap_acquire_object(tx_object);
+    }
+    if (rx_object != NULL)
+    {
+      jsmbed_wrap_acquire_object(rx_object);
+    }
+    jsmbed_wrap_acquire_object(callback);
+    mailman.set_post_function(callback);
+  }
+
+  ~BusAsyncTransfer()
+  {
+    jsmbed_wrap_release_object(bus_object);
+    if (tx_object != NULL)
+    {
+      jsmbed_wrap_release_object(tx_object);
+    }
+    if (rx_object != NULL)
+    {
+      jsmbed_wrap_release_object(rx_object);
+    }
+  }
+
+  JSFunctionMailman mailman;
+
+private:
+  jerry_object_t *bus_object;
+  jerry_object_t *tx_object;
+  jerry_object_t *rx_object;
+};
+
+static JSObjectPool<BusAsyncTransfer, JSMBED_BUS_ASYNC_QUEUE_SIZE> bus_async_transfer_pool("BusAsync");
+
+// Called on the event loop. The callback is posted rather than called
+// directly, so that it runs after the transfer's references are dropped.
+static void jsmbed_bus_async_complete(void *context, int result)
+{
+  BusAsyncTransfer *transfer = (BusAsyncTransfer*) context;
+  jerry_value_t result_value;
+  jsmbed_wrap_box_uint32(&result_value, result);
+  transfer->mailman.post_call_callback_msg_1arg(result_value);
+  bus_async_transfer_pool.destroy(transfer);
+}
+
+/*
+ * Shared by readAsync and writeAsync, which take (address, typed array,
+ * [length, [repeated,]] callback). The callback is always last, and is
+ * called with the same status the synchronous versions return.
+ */
+static bool jsmbed_i2c_transfer_async(const char *name,
+                                      bool is_read,
+                                      const jerry_value_t *this_p,
+                                      const jerry_value_t args_p[],
+                                      const jerry_length_t args_count)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[1]);
+  int length = (args_count >= 4) ? jsmbed_wrap_unbox_number(&args_p[2]) : data->get_byte_length();
+  bool repeated = (args_count == 5) ? jsmbed_wrap_unbox_boolean(&args_p[3]) : false;
+  jerry_object_t *callback = jsmbed_wrap_unbox_object(&args_p[args_count - 1]);
+
+  if (length < 0 || (uint32_t) length > data->get_byte_length())
+  {
+    printf("ERROR: I2C.%s length %d is larger than the typed array passed in.\n", name, length);
+    return false;
+  }
+
+  jerry_object_t *data_object = jsmbed_wrap_unbox_object(&args_p[1]);
+  BusAsyncTransfer *transfer = bus_async_transfer_pool.construct(jsmbed_wrap_unbox_object(this_p),
+                                                                 data_object, (jerry_object_t*) NULL, callback);
+  if (transfer == NULL)
+  {
+    return false;
+  }
+
+  if (!NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, transfer_async)(native_handle, is_read, address,
+        (char*) data->get_data(), length, repeated, jsmbed_bus_async_complete, transfer))
+  {
+    printf("ERROR: I2C.%s called with %d transfers already queued.\n", name, JSMBED_BUS_ASYNC_QUEUE_SIZE);
+    bus_async_transfer_pool.destroy(transfer);
+    return false;
+  }
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, readAsync, I_TA_F)
+{
+  return jsmbed_i2c_transfer_async("readAsync", true, this_p, args_p, args_count);
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, readAsync, I_TA_I_F)
+{
+  return jsmbed_i2c_transfer_async("readAsync", true, this_p, args_p, args_count);
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, readAsync, I_TA_I_B_F)
+{
+  return jsmbed_i2c_transfer_async("readAsync", true, this_p, args_p, args_count);
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOADS(I2C, readAsync)
+{
+  CLASS_FUNCTION_OVERLOAD(I2C, readAsync, I_TA_F, "ntf"),
+  CLASS_FUNCTION_OVERLOAD(I2C, readAsync, I_TA_I_F, "ntnf"),
+  CLASS_FUNCTION_OVERLOAD(I2C, readAsync, I_TA_I_B_F, "ntnbf")
+};
+
+DISPATCH_CLASS_FUNCTION_OVERLOADS(I2C, readAsync)
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, writeAsync, I_TA_F)
+{
+  return jsmbed_i2c_transfer_async("writeAsync", false, this_p, args_p, args_count);
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, writeAsync, I_TA_I_F)
+{
+  return jsmbed_i2c_transfer_async("writeAsync", false, this_p, args_p, args_count);
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, writeAsync, I_TA_I_B_F)
+{
+  return jsmbed_i2c_transfer_async("writeAsync", false, this_p, args_p, args_count);
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOADS(I2C, writeAsync)
+{
+  CLASS_FUNCTION_OVERLOAD(I2C, writeAsync, I_TA_F, "ntf"),
+  CLASS_FUNCTION_OVERLOAD(I2C, writeAsync, I_TA_I_F, "ntnf"),
+  CLASS_FUNCTION_OVERLOAD(I2C, writeAsync, I_TA_I_B_F, "ntnbf")
+};
+
+DISPATCH_CLASS_FUNCTION_OVERLOADS(I2C, writeAsync)
+
+#ifndef JSMBED_POOL_SIZE_I2C_PROGRAM
+#  define JSMBED_POOL_SIZE_I2C_PROGRAM 4
+#endif
+
+static JSObjectPool<jsmbed_i2c_program_t, JSMBED_POOL_SIZE_I2C_PROGRAM> i2c_program_pool("I2CProgram");
+
+// Also releases the typed arrays the program's ops refer to.
+static void jsmbed_i2c_program_destroy(uintptr_t handle)
+{
+  jsmbed_i2c_program_t *program = (jsmbed_i2c_program_t*) handle;
+  for (int index = 0; index < program->op_count; index++)
+  {
+    if (program->ops[index].buffer != NULL)
+    {
+      jsmbed_wrap_release_object(program->ops[index].buffer);
+    }
+  }
+  i2c_program_pool.destroy(program);
+}
+
+static jsmbed_i2c_program_t *jsmbed_i2c_alloc_program()
+{
+  jsmbed_i2c_program_t *program = (jsmbed_i2c_program_t*) i2c_program_pool.alloc();
+  if (program == NULL)
+  {
+    printf("ERROR: Out of memory for I2C program.\n");
+    return NULL;
+  }
+  program = new (program) jsmbed_i2c_program_t;
+  program->op_count = 0;
+  program->byte_count = 0;
+  return program;
+}
+
+static jsmbed_i2c_program_t *jsmbed_i2c_get_program(const jerry_value_t *val_p)
+{
+  return (jsmbed_i2c_program_t*) jsmbed_wrap_get_native_handle_of_type(val_p, jsmbed_i2c_program_destroy);
+}
+
+/*
+ * Compiles one op, given its fields. An op is one of
+ *
+ *   ['write', address, data[, repeated]]
+ *   ['read', address, typedArray[, repeated]]
+ *   ['delay', microseconds]
+ *
+ * Write data can be a typed array, which is used in place, so its contents
+ * can be changed between runs, or an array of bytes, which is copied into
+ * the program. The program holds a reference to every typed array it uses.
+ */
+static bool jsmbed_i2c_compile_op(jsmbed_i2c_program_t *program, int index,
+                                  const jerry_value_t fields[], int field_count)
+{
+  if (field_count == 0 || !jsmbed_wrap_value_is_string(&fields[0]))
+  {
+    printf("ERROR: I2C op %d should start with 'write', 'read' or 'delay'.\n", index);
+    return false;
+  }
+
+  jerry_string_t *code = jsmbed_wrap_unbox_string(&fields[0]);
+  jsmbed_i2c_op_t *op = &program->ops[index];
+  op->repeated = false;
+  op->address = 0;
+  op->data = NULL;
+  op->length = 0;
+  op->buffer = NULL;
+
+  if (jsmbed_wrap_string_equals(code, "delay"))
+  {
+    // Checked as a double, so that NaN is rejected too.
+    if (field_count != 2 || !jsmbed_wrap_value_is_number(&fields[1]) ||
+        !(jsmbed_wrap_unbox_number(&fields[1]) >= 0))
+    {
+      printf("ERROR: I2C op %d should be ['delay', microseconds], with microseconds >= 0.\n", index);
+      return false;
+    }
+    op->code = JSMBED_I2C_OP_DELAY;
+    op->length = jsmbed_wrap_unbox_number(&fields[1]);
+    return true;
+  }
+
+  bool is_read = jsmbed_wrap_string_equals(code, "read");
+  if (!is_read && !jsmbed_wrap_string_equals(code, "write"))
+  {
+    printf("ERROR: I2C op %d should start with 'write', 'read' or 'delay'.\n", index);
+    return false;
+  }
+
+  if (field_count < 3 || field_count > 4 ||
+      !jsmbed_wrap_value_is_number(&fields[1]) ||
+      !jsmbed_wrap_value_is_object(&fields[2]) ||
+      (field_count == 4 && !jsmbed_wrap_value_is_boolean(&fields[3])))
+  {
+    printf("ERROR: I2C op %d should be ['%s', address, data[, repeated]].\n", index, is_read ? "read" : "write");
+    return false;
+  }
+
+  op->code = is_read ? JSMBED_I2C_OP_READ : JSMBED_I2C_OP_WRITE;
+  op->address = jsmbed_wrap_unbox_number(&fields[1]);
+  op->repeated = (field_count == 4) ? jsmbed_wrap_unbox_boolean(&fields[3]) : false;
+
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&fields[2]);
+  if (data != NULL)
+  {
+    op->data = (char*) data->get_data();
+    op->length = data->get_byte_length();
+    op->buffer = jsmbed_wrap_unbox_object(&fields[2]);
+    jsmbed_wrap_acquire_object(op->buffer);
+    return true;
+  }
+
+  if (is_read)
+  {
+    printf("ERROR: I2C op %d should read into a typed array.\n", index);
+    return false;
+  }
+
+  int length = jsmbed_wrap_get_array_length(&fields[2]);
+  if (program->byte_count + length > JSMBED_I2C_PROGRAM_MAX_BYTES)
+  {
+    printf("ERROR: I2C op %d has more than %d bytes of constant data in total, use a typed array.\n",
+           index, JSMBED_I2C_PROGRAM_MAX_BYTES);
+    return false;
+  }
+  op->data = &program->bytes[program->byte_count];
+  op->length = length;
+  jsmbed_wrap_copy_char_array_from_js_array(op->data, &fields[2]);
+  program->byte_count += length;
+  return true;
+}
+
+static bool jsmbed_i2c_compile(jsmbed_i2c_program_t *program, const jerry_value_t *ops_p)
+{
+  int op_count = jsmbed_wrap_get_array_length(ops_p);
+  if (op_count > JSMBED_I2C_PROGRAM_MAX_OPS)
+  {
+    printf("ERROR: I2C programs can have at most %d ops, got %d.\n", JSMBED_I2C_PROGRAM_MAX_OPS, op_count);
+    return false;
+  }
+
+  jerry_object_t *ops_array = jsmbed_wrap_unbox_object(ops_p);
+  for (int index = 0; index < op_count; index++)
+  {
+    jerry_value_t op_value;
+    jerry_value_t fields[4];
+    int field_count = 0;
+
+    if (jerry_get_array_index_value(ops_array, index, &op_value))
+    {
+      if (jsmbed_wrap_value_is_object(&op_value))
+      {
+        field_count = jsmbed_wrap_get_array_length(&op_value);
+        if (field_count > 4)
+        {
+          field_count = 0;
+        }
+        for (int field = 0; field < field_count; field++)
+        {
+          jerry_get_array_index_value(jsmbed_wrap_unbox_object(&op_value), field, &fields[field]);
+        }
+      }
+      jerry_release_value(&op_value);
+    }
+
+    // The fields are released straight away: the op holds its own
+    // reference to any typed array it uses.
+    bool compiled = jsmbed_i2c_compile_op(program, index, fields, field_count);
+    for (int field = 0; field < field_count; field++)
+    {
+      jerry_release_value(&fields[field]);
+    }
+    if (!compiled)
+    {
+      return false;
+    }
+    program->op_count++;
+  }
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(I2C, compile)
+{
+  CHECK_ARGUMENT_COUNT(I2C, compile, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, compile, 0, object);
+
+  jsmbed_i2c_program_t *program = jsmbed_i2c_alloc_program();
+  if (program == NULL)
+  {
+    return false;
+  }
+  if (!jsmbed_i2c_compile(program, &args_p[0]))
+  {
+    jsmbed_i2c_program_destroy((uintptr_t) program);
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_typed_objects(js_object, &program->link, (uintptr_t) program, jsmbed_i2c_program_destroy);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+// Takes a program from I2C.compile, or an ops array to compile and run once.
+DECLARE_CLASS_FUNCTION(I2C, transact)
+{
+  CHECK_ARGUMENT_COUNT(I2C, transact, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, transact, 0, object);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+
+  jsmbed_i2c_program_t *program = jsmbed_i2c_get_program(&args_p[0]);
+  if (program != NULL)
+  {
+    int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, transact)(native_handle, program);
+    jsmbed_wrap_box_uint32(ret_val_p, result);
+    return true;
+  }
+
+  program = jsmbed_i2c_alloc_program();
+  if (program == NULL)
+  {
+    return false;
+  }
+  bool compiled = jsmbed_i2c_compile(program, &args_p[0]);
+  if (compiled)
+  {
+    int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, transact)(native_handle, program);
+    jsmbed_wrap_box_uint32(ret_val_p, result);
+  }
+  jsmbed_i2c_program_destroy((uintptr_t) program);
+  return compiled;
+}
+
+/*
+ * Unboxes the optional (bits, littleEndian) arguments of the register
+ * helpers, which start at INDEX. Registers are 8-bit, big-endian by default.
+ */
+static bool jsmbed_i2c_unbox_register_format(const char *name,
+                                             const jerry_value_t args_p[],
+                                             const jerry_length_t args_count,
+                                             jerry_length_t index,
+                                             int *bits,
+                                             bool *little_endian)
+{
+  *bits = (args_count > index) ? jsmbed_wrap_unbox_number(&args_p[index]) : 8;
+  *little_endian = (args_count > index + 1) ? jsmbed_wrap_unbox_boolean(&args_p[index + 1]) : false;
+  if (*bits != 8 && *bits != 16)
+  {
+    printf("ERROR: I2C.%s registers can be 8 or 16 bits wide, not %d.\n", name, *bits);
+    return false;
+  }
+  return true;
+}
+
+// Returns the register's value, or -1 if the transfer failed.
+DECLARE_CLASS_FUNCTION(I2C, readRegister)
+{
+  CHECK_ARGUMENT_COUNT(I2C, readRegister, (args_count >= 2 && args_count <= 4));
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, readRegister, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, readRegister, 1, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(I2C, readRegister, 2, number, (args_count >= 3));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(I2C, readRegister, 3, boolean, (args_count == 4));
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  int reg = jsmbed_wrap_unbox_number(&args_p[1]);
+  int bits;
+  bool little_endian;
+  if (!jsmbed_i2c_unbox_register_format("readRegister", args_p, args_count, 2, &bits, &little_endian))
+  {
+    return false;
+  }
+
+  uint32_t value;
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_register)
+      (native_handle, address, reg, bits, little_endian, &value);
+  if (result == 0)
+  {
+    jsmbed_wrap_box_uint32(ret_val_p, value);
+  }
+  else
+  {
+    jsmbed_wrap_box_number(ret_val_p, -1);
+  }
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(I2C, writeRegister)
+{
+  CHECK_ARGUMENT_COUNT(I2C, writeRegister, (args_count >= 3 && args_count <= 5));
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, writeRegister, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, writeRegister, 1, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, writeRegister, 2, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(I2C, writeRegister, 3, number, (args_count >= 4));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(I2C, writeRegister, 4, boolean, (args_count == 5));
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  int reg = jsmbed_wrap_unbox_number(&args_p[1]);
+  uint32_t value = jsmbed_unbox_bits(&args_p[2]);
+  int bits;
+  bool little_endian;
+  if (!jsmbed_i2c_unbox_register_format("writeRegister", args_p, args_count, 3, &bits, &little_endian))
+  {
+    return false;
+  }
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_register)
+      (native_handle, address, reg, bits, little_endian, value);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+// Read-modify-write of the bits in mask, which skips the write if they
+// already have the right value.
+DECLARE_CLASS_FUNCTION(I2C, updateBits)
+{
+  CHECK_ARGUMENT_COUNT(I2C, updateBits, (args_count >= 4 && args_count <= 6));
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, updateBits, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, updateBits, 1, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, updateBits, 2, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, updateBits, 3, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(I2C, updateBits, 4, number, (args_count >= 5));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(I2C, updateBits, 5, boolean, (args_count == 6));
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  int reg = jsmbed_wrap_unbox_number(&args_p[1]);
+  uint32_t mask = jsmbed_unbox_bits(&args_p[2]);
+  uint32_t value = jsmbed_unbox_bits(&args_p[3]);
+  int bits;
+  bool little_endian;
+  if (!jsmbed_i2c_unbox_register_format("updateBits", args_p, args_count, 4, &bits, &little_endian))
+  {
+    return false;
+  }
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, update_bits)
+      (native_handle, address, reg, bits, little_endian, mask, value);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+// Burst read starting at reg, straight into the typed array.
+DECLARE_CLASS_FUNCTION(I2C, readRegisters)
+{
+  CHECK_ARGUMENT_COUNT(I2C, readRegisters, (args_count == 3));
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, readRegisters, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, readRegisters, 1, number);
+
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[2]);
+  if (data == NULL)
+  {
+    printf("ERROR: I2C.readRegisters reads into a typed array.\n");
+    return false;
+  }
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  int reg = jsmbed_wrap_unbox_number(&args_p[1]);
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, read_registers)
+      (native_handle, address, reg, (char*) data->get_data(), data->get_byte_length());
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, writeRegisters, I_I_TA)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  int reg = jsmbed_wrap_unbox_number(&args_p[1]);
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[2]);
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_registers)
+      (native_handle, address, reg, (const char*) data->get_data(), data->get_byte_length());
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(I2C, writeRegisters, I_I_KPC)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int address = jsmbed_wrap_unbox_number(&args_p[0]);
+  int reg = jsmbed_wrap_unbox_number(&args_p[1]);
+  int length = jsmbed_wrap_get_array_length(&args_p[2]);
+  char *data = jsmbed_wrap_scratch_alloc_same_sized_char_array(&args_p[2]);
+  if (data == NULL)
+  {
+    printf("ERROR: Out of memory in I2C.writeRegisters.\n");
+    return false;
+  }
+  jsmbed_wrap_copy_char_array_from_js_array(data, &args_p[2]);
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(I2C, write_registers)
+      (native_handle, address, reg, data, length);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+
+  jsmbed_wrap_scratch_free(data);
+
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOADS(I2C, writeRegisters)
+{
+  CLASS_FUNCTION_OVERLOAD(I2C, writeRegisters, I_I_TA, "nnt"),
+  CLASS_FUNCTION_OVERLOAD(I2C, writeRegisters, I_I_KPC, "nno")
+};
+
+DISPATCH_CLASS_FUNCTION_OVERLOADS(I2C, writeRegisters)
+
+DECLARE_CLASS_CONSTRUCTOR(I2C)
+{
+  CHECK_ARGUMENT_COUNT(I2C, __constructor, (args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, __constructor, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(I2C, __constructor, 1, number);
+
+  int sda = jsmbed_wrap_unbox_number(&args_p[0]);
+  int scl = jsmbed_wrap_unbox_number(&args_p[1]);
+
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(I2C, I_I) (sda, scl);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(I2C));
+  ATTACH_CLASS_FUNCTION(js_object, I2C, frequency);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, read);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, write);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, readAsync);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, writeAsync);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, compile);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, transact);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, readRegister);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, writeRegister);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, updateBits);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, readRegisters);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, writeRegisters);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, start);
+  ATTACH_CLASS_FUNCTION(js_object, I2C, stop);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// SPI
+//
+DECLARE_CLASS_FUNCTION(SPI, format)
+{
+  CHECK_ARGUMENT_COUNT(SPI, format, (args_count == 1 || args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(SPI, format, 0, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(SPI, format, 1, number, (args_count == 2));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int bits = jsmbed_wrap_unbox_number(&args_p[0]);
+  int mode = (args_count == 2) ? jsmbed_wrap_unbox_number(&args_p[1]) : 0;
+  NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, format)(native_handle, bits, mode);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(SPI, frequency)
+{
+  CHECK_ARGUMENT_COUNT(SPI, frequency, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(SPI, frequency, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int hz = jsmbed_wrap_unbox_number(&args_p[0]);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, frequency)(native_handle, hz);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(SPI, write)
+{
+  CHECK_ARGUMENT_COUNT(SPI, write, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(SPI, write, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int value = jsmbed_wrap_unbox_number(&args_p[0]);
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, write)(native_handle, value);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+/*
+ * Unboxes the (tx, rx) typed arrays of a block transfer, where tx can be
+ * null to only receive, and rx can be left out to only send. The transfer
+ * is as long as the shorter of the two.
+ */
+static bool jsmbed_spi_unbox_buffers(const char *name,
+                                     const jerry_value_t args_p[],
+                                     jerry_length_t buffer_count,
+                                     JSTypedArray **tx,
+                                     JSTypedArray **rx,
+                                     int *length)
+{
+  *tx = jsmbed_wrap_get_typed_array(&args_p[0]);
+  *rx = (buffer_count == 2) ? jsmbed_wrap_get_typed_array(&args_p[1]) : NULL;
+  if (*tx == NULL && *rx == NULL)
+  {
+    printf("ERROR: SPI.%s needs a typed array to send or receive.\n", name);
+    return false;
+  }
+
+  if (*tx == NULL)
+  {
+    *length = (*rx)->get_byte_length();
+  }
+  else if (*rx == NULL)
+  {
+    *length = (*tx)->get_byte_length();
+  }
+  else
+  {
+    *length = ((*tx)->get_byte_length() < (*rx)->get_byte_length()) ?
+      (*tx)->get_byte_length() : (*rx)->get_byte_length();
+  }
+  return true;
+}
+
+// Returns the number of bytes transferred.
+DECLARE_CLASS_FUNCTION_OVERLOAD(SPI, transfer, TA_TA)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  JSTypedArray *tx;
+  JSTypedArray *rx;
+  int length;
+  if (!jsmbed_spi_unbox_buffers("transfer", args_p, args_count, &tx, &rx, &length))
+  {
+    return false;
+  }
+
+  int result = NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, transfer)(native_handle,
+      (tx != NULL) ? (const char*) tx->get_data() : NULL,
+      (rx != NULL) ? (char*) rx->get_data() : NULL,
+      length);
+  jsmbed_wrap_box_uint32(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOADS(SPI, transfer)
+{
+  CLASS_FUNCTION_OVERLOAD(SPI, transfer, TA_TA, "t|t"),
+  CLASS_FUNCTION_OVERLOAD(SPI, transfer, TA_TA, "zt")
+};
+
+DISPATCH_CLASS_FUNCTION_OVERLOADS(SPI, transfer)
+
+// As transfer, with the callback called from the event loop, with the
+// number of bytes transferred, once it's done.
+DECLARE_CLASS_FUNCTION_OVERLOAD(SPI, transferAsync, TA_TA_F)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  JSTypedArray *tx;
+  JSTypedArray *rx;
+  int length;
+  if (!jsmbed_spi_unbox_buffers("transferAsync", args_p, args_count - 1, &tx, &rx, &length))
+  {
+    return false;
+  }
+
+  jerry_object_t *callback = jsmbed_wrap_unbox_object(&args_p[args_count - 1]);
+  BusAsyncTransfer *transfer = bus_async_transfer_pool.construct(jsmbed_wrap_unbox_object(this_p),
+      (tx != NULL) ? jsmbed_wrap_unbox_object(&args_p[0]) : (jerry_object_t*) NULL,
+      (rx != NULL) ? jsmbed_wrap_unbox_object(&args_p[1]) : (jerry_object_t*) NULL,
+      callback);
+  if (transfer == NULL)
+  {
+    return false;
+  }
+
+  if (!NAME_FOR_CLASS_NATIVE_FUNCTION(SPI, transfer_async)(native_handle,
+        (tx != NULL) ? (const char*) tx->get_data() : NULL,
+        (rx != NULL) ? (char*) rx->get_data() : NULL,
+        length, jsmbed_bus_async_complete, transfer))
+  {
+    printf("ERROR: SPI.transferAsync called with %d transfers already queued.\n", JSMBED_BUS_ASYNC_QUEUE_SIZE);
+    bus_async_transfer_pool.destroy(transfer);
+    return false;
+  }
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOADS(SPI, transferAsync)
+{
+  CLASS_FUNCTION_OVERLOAD(SPI, transferAsync, TA_TA_F, "tf"),
+  CLASS_FUNCTION_OVERLOAD(SPI, transferAsync, TA_TA_F, "ttf"),
+  CLASS_FUNCTION_OVERLOAD(SPI, transferAsync, TA_TA_F, "ztf")
+};
+
+DISPATCH_CLASS_FUNCTION_OVERLOADS(SPI, transferAsync)
+
+DECLARE_CLASS_CONSTRUCTOR(SPI)
+{
+  CHECK_ARGUMENT_COUNT(SPI, __constructor, (args_count == 3 || args_count == 4));
+  CHECK_ARGUMENT_TYPE_ALWAYS(SPI, __constructor, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(SPI, __constructor, 1, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(SPI, __constructor, 2, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(SPI, __constructor, 3, number, (args_count == 4));
+
+  int mosi = jsmbed_wrap_unbox_number(&args_p[0]);
+  int miso = jsmbed_wrap_unbox_number(&args_p[1]);
+  int sclk = jsmbed_wrap_unbox_number(&args_p[2]);
+
+  uintptr_t native_handle;
+  if (args_count == 4)
+  {
+    int ssel = jsmbed_wrap_unbox_number(&args_p[3]);
+    native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(SPI, I_I_I_I) (mosi, miso, sclk, ssel);
+  }
+  else
+  {
+    native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(SPI, I_I_I) (mosi, miso, sclk);
+  }
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(SPI));
+  ATTACH_CLASS_FUNCTION(js_object, SPI, format);
+  ATTACH_CLASS_FUNCTION(js_object, SPI, frequency);
+  ATTACH_CLASS_FUNCTION(js_object, SPI, write);
+  ATTACH_CLASS_FUNCTION(js_object, SPI, transfer);
+  ATTACH_CLASS_FUNCTION(js_object, SPI, transferAsync);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// Serial
+//
+DECLARE_CLASS_FUNCTION(Serial, baud)
+{
+  CHECK_ARGUMENT_COUNT(Serial, baud, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(Serial, baud, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int rate = jsmbed_wrap_unbox_number(&args_p[0]);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, baud)(native_handle, rate);
+  return true;
+}
+
+// Called with the number of bytes available. Pass null to stop.
+DECLARE_CLASS_FUNCTION(Serial, onData)
+{
+  CHECK_ARGUMENT_COUNT(Serial, onData, (args_count == 1));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+
+  jerry_object_t *fptr = NULL;
+  if (!jsmbed_wrap_value_is_null(&args_p[0]))
+  {
+    CHECK_ARGUMENT_TYPE_ALWAYS(Serial, onData, 0, function);
+    fptr = jsmbed_wrap_unbox_object(&args_p[0]);
+    jsmbed_wrap_acquire_object(fptr);
+  }
+  NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, on_data)(native_handle, fptr);
+  return true;
+}
+
+// Takes a character code, or a one character string. -1 disables it.
+DECLARE_CLASS_FUNCTION(Serial, setDelimiter)
+{
+  CHECK_ARGUMENT_COUNT(Serial, setDelimiter, (args_count == 1));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+
+  int delimiter;
+  if (jsmbed_wrap_value_is_string(&args_p[0]))
+  {
+    JSStackString<4> delimiter_string(jsmbed_wrap_unbox_string(&args_p[0]));
+    if (delimiter_string.c_str() == NULL || delimiter_string.get_size() != 1)
+    {
+      printf("ERROR: Serial.setDelimiter takes a single character.\n");
+      return false;
+    }
+    delimiter = (uint8_t) delimiter_string.c_str()[0];
+  }
+  else
+  {
+    CHECK_ARGUMENT_TYPE_ALWAYS(Serial, setDelimiter, 0, number);
+    delimiter = jsmbed_wrap_unbox_number(&args_p[0]);
+  }
+  NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, set_delimiter)(native_handle, delimiter);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(Serial, setThreshold)
+{
+  CHECK_ARGUMENT_COUNT(Serial, setThreshold, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(Serial, setThreshold, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int threshold = jsmbed_wrap_unbox_number(&args_p[0]);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, set_threshold)(native_handle, threshold);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(Serial, setIdleTimeout)
+{
+  CHECK_ARGUMENT_COUNT(Serial, setIdleTimeout, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(Serial, setIdleTimeout, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int us = jsmbed_wrap_unbox_number(&args_p[0]);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, set_idle_timeout)(native_handle, us);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(Serial, available)
+{
+  CHECK_ARGUMENT_COUNT(Serial, available, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_uint32(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, available)(native_handle));
+  return true;
+}
+
+// Reads as much as is available into the typed array, and returns how much.
+DECLARE_CLASS_FUNCTION(Serial, read)
+{
+  CHECK_ARGUMENT_COUNT(Serial, read, (args_count == 1));
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[0]);
+  if (data == NULL)
+  {
+    printf("ERROR: Serial.read reads into a typed array.\n");
+    return false;
+  }
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int count = NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, read)
+      (native_handle, (char*) data->get_data(), data->get_byte_length());
+  jsmbed_wrap_box_uint32(ret_val_p, count);
+  return true;
+}
+
+// Returns the next line, without its delimiter, or null if there isn't a
+// complete one yet.
+DECLARE_CLASS_FUNCTION(Serial, readLine)
+{
+  CHECK_ARGUMENT_COUNT(Serial, readLine, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+
+  int available = NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, available)(native_handle);
+  char *line = (char*) jsmbed_wrap_scratch_alloc(available + 1);
+  if (line == NULL)
+  {
+    printf("ERROR: Out of memory in Serial.readLine.\n");
+    return false;
+  }
+  int length = NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, read_line)(native_handle, line, available);
+
+  if (length < 0)
+  {
+    ret_val_p->type = JERRY_DATA_TYPE_NULL;
+  }
+  else
+  {
+    jsmbed_wrap_box_string(ret_val_p, jerry_create_string_sz((const jerry_char_t *) line, length));
+  }
+  jsmbed_wrap_scratch_free(line);
+  return true;
+}
+
+// The write overloads queue what fits in the TX buffer without blocking,
+// and return how much that was.
+DECLARE_CLASS_FUNCTION_OVERLOAD(Serial, write, TA)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[0]);
+  int count = NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, write)
+      (native_handle, (const char*) data->get_data(), data->get_byte_length());
+  jsmbed_wrap_box_uint32(ret_val_p, count);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(Serial, write, S)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  JSStackString<> data(jsmbed_wrap_unbox_string(&args_p[0]));
+  if (data.c_str() == NULL)
+  {
+    printf("ERROR: Serial.write could not convert the string.\n");
+    return false;
+  }
+  int count = NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, write)(native_handle, data.c_str(), data.get_size());
+  jsmbed_wrap_box_uint32(ret_val_p, count);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(Serial, write, I)
+{
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  char byte = (char) jsmbed_wrap_unbox_number(&args_p[0]);
+  int count = NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, write)(native_handle, &byte, 1);
+  jsmbed_wrap_box_uint32(ret_val_p, count);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOADS(Serial, write)
+{
+  CLASS_FUNCTION_OVERLOAD(Serial, write, TA, "t"),
+  CLASS_FUNCTION_OVERLOAD(Serial, write, S, "s"),
+  CLASS_FUNCTION_OVERLOAD(Serial, write, I, "n")
+};
+
+DISPATCH_CLASS_FUNCTION_OVERLOADS(Serial, write)
+
+DECLARE_CLASS_FUNCTION(Serial, overflows)
+{
+  CHECK_ARGUMENT_COUNT(Serial, overflows, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_uint32(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, overflows)(native_handle));
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(Serial)
+{
+  CHECK_ARGUMENT_COUNT(Serial, __constructor, (args_count == 2 || args_count == 3));
+  CHECK_ARGUMENT_TYPE_ALWAYS(Serial, __constructor, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(Serial, __constructor, 1, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(Serial, __constructor, 2, number, (args_count == 3));
+
+  int tx = jsmbed_wrap_unbox_number(&args_p[0]);
+  int rx = jsmbed_wrap_unbox_number(&args_p[1]);
+
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(Serial, I_I) (tx, rx);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+  if (args_count == 3)
+  {
+    NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, baud)(native_handle, jsmbed_wrap_unbox_number(&args_p[2]));
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_typed_objects(js_object, NAME_FOR_CLASS_NATIVE_FUNCTION(Serial, link)(native_handle),
+                                 native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Serial));
+  ATTACH_CLASS_FUNCTION(js_object, Serial, baud);
+  ATTACH_CLASS_FUNCTION(js_object, Serial, onData);
+  ATTACH_CLASS_FUNCTION(js_object, Serial, setDelimiter);
+  ATTACH_CLASS_FUNCTION(js_object, Serial, setThreshold);
+  ATTACH_CLASS_FUNCTION(js_object, Serial, setIdleTimeout);
+  ATTACH_CLASS_FUNCTION(js_object, Serial, available);
+  ATTACH_CLASS_FUNCTION(js_object, Serial, read);
+  ATTACH_CLASS_FUNCTION(js_object, Serial, readLine);
+  ATTACH_CLASS_FUNCTION(js_object, Serial, write);
+  ATTACH_CLASS_FUNCTION(js_object, Serial, overflows);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// Framer
+//
+DECLARE_CLASS_FUNCTION(Framer, push)
+{
+  CHECK_ARGUMENT_COUNT(Framer, push, (args_count == 1));
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[0]);
+  if (data == NULL)
+  {
+    printf("ERROR: Framer.push takes a typed array.\n");
+    return false;
+  }
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int frames = NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, push)
+      (native_handle, (const char*) data->get_data(), data->get_byte_length());
+  jsmbed_wrap_box_uint32(ret_val_p, frames);
+  return true;
+}
+
+// Decodes everything buffered by a Serial, without copying it through JS.
+DECLARE_CLASS_FUNCTION(Framer, feed)
+{
+  CHECK_ARGUMENT_COUNT(Framer, feed, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(Framer, feed, 0, object);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  // Only a Serial will do, since its buffer is read directly.
+  uintptr_t serial_handle = jsmbed_wrap_get_native_handle_of_type(&args_p[0],
+      NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Serial));
+  if (serial_handle == 0)
+  {
+    printf("ERROR: Framer.feed takes a Serial.\n");
+    return false;
+  }
+
+  int frames = NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, feed)(native_handle, serial_handle);
+  jsmbed_wrap_box_uint32(ret_val_p, frames);
+  return true;
+}
+
+// Copies the next frame into the typed array, and returns its length, or
+// -1 if there isn't one. A length larger than the array means the frame
+// was truncated.
+DECLARE_CLASS_FUNCTION(Framer, read)
+{
+  CHECK_ARGUMENT_COUNT(Framer, read, (args_count == 1));
+  JSTypedArray *data = jsmbed_wrap_get_typed_array(&args_p[0]);
+  if (data == NULL)
+  {
+    printf("ERROR: Framer.read reads into a typed array.\n");
+    return false;
+  }
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int length = NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, read)
+      (native_handle, (char*) data->get_data(), data->get_byte_length());
+  jsmbed_wrap_box_number(ret_val_p, length);
+  return true;
+}
+
+// Encodes the payload into out, and returns the encoded length, or -1 if
+// it didn't fit.
+DECLARE_CLASS_FUNCTION(Framer, encode)
+{
+  CHECK_ARGUMENT_COUNT(Framer, encode, (args_count == 2));
+  JSTypedArray *payload = jsmbed_wrap_get_typed_array(&args_p[0]);
+  JSTypedArray *out = jsmbed_wrap_get_typed_array(&args_p[1]);
+  if (payload == NULL || out == NULL)
+  {
+    printf("ERROR: Framer.encode takes two typed arrays.\n");
+    return false;
+  }
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int length = NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, encode)
+      (native_handle, (const char*) payload->get_data(), payload->get_byte_length(),
+       (char*) out->get_data(), out->get_byte_length());
+  jsmbed_wrap_box_number(ret_val_p, length);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(Framer, stats)
+{
+  CHECK_ARGUMENT_COUNT(Framer, stats, (args_count <= 1));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(Framer, stats, 0, object, (args_count == 1));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+
+  jsmbed_framer_stats_t native_stats;
+  NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, stats)(native_handle, &native_stats);
+
+  jerry_object_t *stats = jsmbed_wrap_result_object(args_p, args_count, 0);
+  jsmbed_wrap_fill_object(JS_SCHEMA(jsmbed_framer_stats_t), &native_stats, stats);
+
+  jsmbed_wrap_box_object(ret_val_p, stats);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(Framer, resetStats)
+{
+  CHECK_ARGUMENT_COUNT(Framer, resetStats, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(Framer, reset_stats)(native_handle);
+  return true;
+}
+
+// new Framer('cobs' | 'slip' | 'length'[, crc])
+DECLARE_CLASS_CONSTRUCTOR(Framer)
+{
+  CHECK_ARGUMENT_COUNT(Framer, __constructor, (args_count == 1 || args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(Framer, __constructor, 0, string);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(Framer, __constructor, 1, boolean, (args_count == 2));
+
+  jerry_string_t *type_string = jsmbed_wrap_unbox_string(&args_p[0]);
+  int type;
+  if (jsmbed_wrap_string_equals(type_string, "cobs"))
+  {
+    type = JSMBED_FRAMER_COBS;
+  }
+  else if (jsmbed_wrap_string_equals(type_string, "slip"))
+  {
+    type = JSMBED_FRAMER_SLIP;
+  }
+  else if (jsmbed_wrap_string_equals(type_string, "length"))
+  {
+    type = JSMBED_FRAMER_LENGTH_PREFIXED;
+  }
+  else
+  {
+    printf("ERROR: Framer type should be 'cobs', 'slip' or 'length'.\n");
+    return false;
+  }
+  bool crc = (args_count == 2) ? jsmbed_wrap_unbox_boolean(&args_p[1]) : false;
+
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(Framer, I_B) (type, crc);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Framer));
+  ATTACH_CLASS_FUNCTION(js_object, Framer, push);
+  ATTACH_CLASS_FUNCTION(js_object, Framer, feed);
+  ATTACH_CLASS_FUNCTION(js_object, Framer, read);
+  ATTACH_CLASS_FUNCTION(js_object, Framer, encode);
+  ATTACH_CLASS_FUNCTION(js_object, Framer, stats);
+  ATTACH_CLASS_FUNCTION(js_object, Framer, resetStats);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// AnalogIn
+//
+DECLARE_CLASS_FUNCTION(AnalogIn, read)
+{
+  CHECK_ARGUMENT_COUNT(AnalogIn, read, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_number(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogIn, read)(native_handle));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(AnalogIn, read_u16)
+{
+  CHECK_ARGUMENT_COUNT(AnalogIn, read_u16, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_uint32(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogIn, read_u16)(native_handle));
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(AnalogIn)
+{
+  CHECK_ARGUMENT_COUNT(AnalogIn, __constructor, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(AnalogIn, __constructor, 0, number);
+
+  int pin = jsmbed_wrap_unbox_number(&args_p[0]);
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(AnalogIn, I) (pin);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(AnalogIn));
+  ATTACH_CLASS_FUNCTION(js_object, AnalogIn, read);
+  ATTACH_CLASS_FUNCTION(js_object, AnalogIn, read_u16);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// AnalogSampler
+//
+// start(rate, blockA, blockB, callback[, decimation]) samples at rate Hz,
+// averaging every decimation samples into one value, and calls back with
+// blockA or blockB (Uint16Arrays of the same length) as each one fills.
+// The block is only valid until the sampler comes back round to it.
+DECLARE_CLASS_FUNCTION(AnalogSampler, start)
+{
+  CHECK_ARGUMENT_COUNT(AnalogSampler, start, (args_count == 4 || args_count == 5));
+  CHECK_ARGUMENT_TYPE_ALWAYS(AnalogSampler, start, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(AnalogSampler, start, 3, function);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(AnalogSampler, start, 4, number, (args_count == 5));
+
+  JSTypedArray *block_a = jsmbed_wrap_get_typed_array(&args_p[1]);
+  JSTypedArray *block_b = jsmbed_wrap_get_typed_array(&args_p[2]);
+  if (block_a == NULL || block_b == NULL
+      || block_a->get_type() != TYPED_ARRAY_UINT16 || block_b->get_type() != TYPED_ARRAY_UINT16)
+  {
+    printf("ERROR: AnalogSampler.start samples into two Uint16Arrays.\n");
+    return false;
+  }
+  if (block_a->get_length() == 0 || block_a->get_length() != block_b->get_length()
+      || block_a->get_data() == block_b->get_data())
+  {
+    printf("ERROR: AnalogSampler.start needs two separate blocks of the same, non-zero length.\n");
+    return false;
+  }
+
+  double rate = jsmbed_wrap_unbox_number(&args_p[0]);
+  if (rate <= 0 || rate > 1000000)
+  {
+    printf("ERROR: AnalogSampler.start rate must be between 0 and 1000000 Hz.\n");
+    return false;
+  }
+  int decimation = (args_count == 5) ? (int) jsmbed_wrap_unbox_number(&args_p[4]) : 1;
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jerry_object_t *fptr = jsmbed_wrap_unbox_object(&args_p[3]);
+  jsmbed_wrap_acquire_object(fptr);
+  // Held until stop, as is the sampler itself.
+  jerry_object_t *owner = jsmbed_wrap_unbox_object(this_p);
+  jerry_object_t *block_a_object = jsmbed_wrap_unbox_object(&args_p[1]);
+  jerry_object_t *block_b_object = jsmbed_wrap_unbox_object(&args_p[2]);
+  jsmbed_wrap_acquire_object(owner);
+  jsmbed_wrap_acquire_object(block_a_object);
+  jsmbed_wrap_acquire_object(block_b_object);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, start)(native_handle,
+      owner, (int) (1000000 / rate), decimation,
+      block_a_object, (uint16_t*) block_a->get_data(),
+      block_b_object, (uint16_t*) block_b->get_data(),
+      block_a->get_length(), fptr);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(AnalogSampler, stop)
+{
+  CHECK_ARGUMENT_COUNT(AnalogSampler, stop, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, stop)(native_handle);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(AnalogSampler, running)
+{
+  CHECK_ARGUMENT_COUNT(AnalogSampler, running, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_boolean(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, running)(native_handle));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(AnalogSampler, overruns)
+{
+  CHECK_ARGUMENT_COUNT(AnalogSampler, overruns, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_uint32(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(AnalogSampler, overruns)(native_handle));
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(AnalogSampler)
+{
+  CHECK_ARGUMENT_COUNT(AnalogSampler, __constructor, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(AnalogSampler, __constructor, 0, number);
+
+  int pin = jsmbed_wrap_unbox_number(&args_p[0]);
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(AnalogSampler, I) (pin);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(AnalogSampler));
+  ATTACH_CLASS_FUNCTION(js_object, AnalogSampler, start);
+  ATTACH_CLASS_FUNCTION(js_object, AnalogSampler, stop);
+  ATTACH_CLASS_FUNCTION(js_object, AnalogSampler, running);
+  ATTACH_CLASS_FUNCTION(js_object, AnalogSampler, overruns);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// PwmOut
+//
+DECLARE_CLASS_FUNCTION(PwmOut, period)
+{
+  CHECK_ARGUMENT_COUNT(PwmOut, period, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PwmOut, period, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, period)(native_handle, jsmbed_wrap_unbox_number(&args_p[0]));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(PwmOut, period_us)
+{
+  CHECK_ARGUMENT_COUNT(PwmOut, period_us, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PwmOut, period_us, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, period_us)(native_handle, jsmbed_wrap_unbox_number(&args_p[0]));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(PwmOut, pulsewidth)
+{
+  CHECK_ARGUMENT_COUNT(PwmOut, pulsewidth, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PwmOut, pulsewidth, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, pulsewidth)(native_handle, jsmbed_wrap_unbox_number(&args_p[0]));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(PwmOut, pulsewidth_us)
+{
+  CHECK_ARGUMENT_COUNT(PwmOut, pulsewidth_us, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PwmOut, pulsewidth_us, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, pulsewidth_us)(native_handle, jsmbed_wrap_unbox_number(&args_p[0]));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(PwmOut, write)
+{
+  CHECK_ARGUMENT_COUNT(PwmOut, write, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PwmOut, write, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, write)(native_handle, jsmbed_wrap_unbox_number(&args_p[0]));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(PwmOut, read)
+{
+  CHECK_ARGUMENT_COUNT(PwmOut, read, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_number(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, read)(native_handle));
+  return true;
+}
+
+/*
+ * rampTo(duty, ms[, curve][, callback]), where curve is 'linear' (the
+ * default), 'smooth' or 'gamma'.
+ */
+static bool jsmbed_pwm_ramp_to(const jerry_value_t *this_p,
+                               const jerry_value_t args_p[],
+                               const jerry_length_t args_count)
+{
+  int curve = JSMBED_PWM_CURVE_LINEAR;
+  if (args_count >= 3 && jsmbed_wrap_value_is_string(&args_p[2]))
+  {
+    jerry_string_t *curve_string = jsmbed_wrap_unbox_string(&args_p[2]);
+    if (jsmbed_wrap_string_equals(curve_string, "smooth"))
+    {
+      curve = JSMBED_PWM_CURVE_SMOOTH;
+    }
+    else if (jsmbed_wrap_string_equals(curve_string, "gamma"))
+    {
+      curve = JSMBED_PWM_CURVE_GAMMA;
+    }
+    else if (!jsmbed_wrap_string_equals(curve_string, "linear"))
+    {
+      printf("ERROR: PwmOut.rampTo curve should be 'linear', 'smooth' or 'gamma'.\n");
+      return false;
+    }
+  }
+
+  // Checked as a double, so that NaN is rejected too.
+  double ms_value = jsmbed_wrap_unbox_number(&args_p[1]);
+  if (!(ms_value >= 0))
+  {
+    printf("ERROR: PwmOut.rampTo duration must be at least 0ms.\n");
+    return false;
+  }
+  int ms = (ms_value > INT_MAX) ? INT_MAX : (int) ms_value;
+
+  jerry_object_t *fptr = NULL;
+  if (jsmbed_wrap_value_is_object(&args_p[args_count - 1])
+      && jsmbed_wrap_value_is_function(&args_p[args_count - 1]))
+  {
+    fptr = jsmbed_wrap_unbox_object(&args_p[args_count - 1]);
+    jsmbed_wrap_acquire_object(fptr);
+  }
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  float duty = jsmbed_wrap_unbox_number(&args_p[0]);
+  jerry_object_t *owner = jsmbed_wrap_unbox_object(this_p);
+  jsmbed_wrap_acquire_object(owner);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, ramp_to)(native_handle, owner, duty, ms, curve, fptr);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(PwmOut, rampTo, F_I_S_F)
+{
+  return jsmbed_pwm_ramp_to(this_p, args_p, args_count);
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(PwmOut, rampTo, F_I_F)
+{
+  return jsmbed_pwm_ramp_to(this_p, args_p, args_count);
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOADS(PwmOut, rampTo)
+{
+  CLASS_FUNCTION_OVERLOAD(PwmOut, rampTo, F_I_S_F, "nn|sf"),
+  CLASS_FUNCTION_OVERLOAD(PwmOut, rampTo, F_I_F, "nnf")
+};
+
+DISPATCH_CLASS_FUNCTION_OVERLOADS(PwmOut, rampTo)
+
+/*
+ * playSequence(sequence, stepUs[, loop][, callback]) writes one duty cycle
+ * per step from a Float32Array (0.0 to 1.0) or a Uint16Array (0 to 65535).
+ * The callback isn't called for a looping sequence, which runs until stop().
+ */
+static bool jsmbed_pwm_play_sequence(const jerry_value_t *this_p,
+                                     const jerry_value_t args_p[],
+                                     const jerry_length_t args_count)
+{
+  JSTypedArray *sequence = jsmbed_wrap_get_typed_array(&args_p[0]);
+  if (sequence->get_type() != TYPED_ARRAY_FLOAT32 && sequence->get_type() != TYPED_ARRAY_UINT16)
+  {
+    printf("ERROR: PwmOut.playSequence takes a Float32Array or a Uint16Array.\n");
+    return false;
+  }
+  if (sequence->get_length() == 0)
+  {
+    printf("ERROR: PwmOut.playSequence sequence is empty.\n");
+    return false;
+  }
+
+  bool loop = (args_count >= 3 && jsmbed_wrap_value_is_boolean(&args_p[2]))
+      ? jsmbed_wrap_unbox_boolean(&args_p[2]) : false;
+
+  jerry_object_t *fptr = NULL;
+  if (jsmbed_wrap_value_is_object(&args_p[args_count - 1])
+      && jsmbed_wrap_value_is_function(&args_p[args_count - 1]))
+  {
+    fptr = jsmbed_wrap_unbox_object(&args_p[args_count - 1]);
+    jsmbed_wrap_acquire_object(fptr);
+  }
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int step_us = jsmbed_wrap_unbox_number(&args_p[1]);
+  jerry_object_t *owner = jsmbed_wrap_unbox_object(this_p);
+  jsmbed_wrap_acquire_object(owner);
+  jerry_object_t *sequence_object = jsmbed_wrap_unbox_object(&args_p[0]);
+  jsmbed_wrap_acquire_object(sequence_object);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, play_sequence)(native_handle,
+      owner, sequence_object, sequence->get_data(),
+      sequence->get_type() == TYPED_ARRAY_UINT16, sequence->get_length(),
+      step_us, loop, fptr);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(PwmOut, playSequence, TA_I_B_F)
+{
+  return jsmbed_pwm_play_sequence(this_p, args_p, args_count);
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOAD(PwmOut, playSequence, TA_I_F)
+{
+  return jsmbed_pwm_play_sequence(this_p, args_p, args_count);
+}
+
+DECLARE_CLASS_FUNCTION_OVERLOADS(PwmOut, playSequence)
+{
+  CLASS_FUNCTION_OVERLOAD(PwmOut, playSequence, TA_I_B_F, "tn|bf"),
+  CLASS_FUNCTION_OVERLOAD(PwmOut, playSequence, TA_I_F, "tnf")
+};
+
+DISPATCH_CLASS_FUNCTION_OVERLOADS(PwmOut, playSequence)
+
+DECLARE_CLASS_FUNCTION(PwmOut, stop)
+{
+  CHECK_ARGUMENT_COUNT(PwmOut, stop, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, stop)(native_handle);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(PwmOut, busy)
+{
+  CHECK_ARGUMENT_COUNT(PwmOut, busy, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_boolean(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(PwmOut, busy)(native_handle));
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(PwmOut)
+{
+  CHECK_ARGUMENT_COUNT(PwmOut, __constructor, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PwmOut, __constructor, 0, number);
+
+  int pin = jsmbed_wrap_unbox_number(&args_p[0]);
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PwmOut, I) (pin);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PwmOut));
+  ATTACH_CLASS_FUNCTION(js_object, PwmOut, period);
+  ATTACH_CLASS_FUNCTION(js_object, PwmOut, period_us);
+  ATTACH_CLASS_FUNCTION(js_object, PwmOut, pulsewidth);
+  ATTACH_CLASS_FUNCTION(js_object, PwmOut, pulsewidth_us);
+  ATTACH_CLASS_FUNCTION(js_object, PwmOut, write);
+  ATTACH_CLASS_FUNCTION(js_object, PwmOut, read);
+  ATTACH_CLASS_FUNCTION(js_object, PwmOut, rampTo);
+  ATTACH_CLASS_FUNCTION(js_object, PwmOut, playSequence);
+  ATTACH_CLASS_FUNCTION(js_object, PwmOut, stop);
+  ATTACH_CLASS_FUNCTION(js_object, PwmOut, busy);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// Ticker
+//
+DECLARE_CLASS_FUNCTION(Ticker, attach)
+{
+  CHECK_ARGUMENT_COUNT(Ticker, attach, (args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(Ticker, attach, 0, function);
+  CHECK_ARGUMENT_TYPE_ALWAYS(Ticker, attach, 1, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jerry_object_t *fptr = jsmbed_wrap_unbox_object(&args_p[0]);
+  jsmbed_wrap_acquire_object(fptr);
+  float t = jsmbed_wrap_unbox_number(&args_p[1]);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(Ticker, attach) (native_handle, fptr, t);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(Ticker, attach_us)
+{
+  CHECK_ARGUMENT_COUNT(Ticker, attach_us, (args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(Ticker, attach_us, 0, function);
+  CHECK_ARGUMENT_TYPE_ALWAYS(Ticker, attach_us, 1, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jerry_object_t *fptr = jsmbed_wrap_unbox_object(&args_p[0]);
+  jsmbed_wrap_acquire_object(fptr);
+  int t = jsmbed_wrap_unbox_number(&args_p[1]);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(Ticker, attach_us) (native_handle, fptr, t);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(Ticker, detach)
+{
+  CHECK_ARGUMENT_COUNT(Ticker, detach, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(Ticker, detach)(native_handle);
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(Ticker)
+{
+  CHECK_ARGUMENT_COUNT(Ticker, __constructor, (args_count == 0));
+
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(Ticker, _) ();
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(Ticker));
+  ATTACH_CLASS_FUNCTION(js_object, Ticker, attach);
+  ATTACH_CLASS_FUNCTION(js_object, Ticker, attach_us);
+  ATTACH_CLASS_FUNCTION(js_object, Ticker, detach);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// InterruptIn
+//
+DECLARE_CLASS_FUNCTION(InterruptIn, rise)
+{
+  CHECK_ARGUMENT_COUNT(InterruptIn, rise, (args_count == 1));
+  // Special case for rise(null), which means "detach the rise callback"
+  if (jsmbed_wrap_value_is_null(&args_p[0]))
+  {
+    uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+    NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, rise) (native_handle, NULL);
+    return true;
+  }
+
+  // Assuming we actually have a callback now...
+  CHECK_ARGUMENT_TYPE_ALWAYS(InterruptIn, rise, 0, function);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jerry_object_t *fptr = jsmbed_wrap_unbox_object(&args_p[0]);
+  jsmbed_wrap_acquire_object(fptr);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, rise) (native_handle, fptr);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(InterruptIn, fall)
+{
+  CHECK_ARGUMENT_COUNT(InterruptIn, fall, (args_count == 1));
+  // Special case for fall(null), which means "detach the fall callback"
+  if (jsmbed_wrap_value_is_null(&args_p[0]))
+  {
+    uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+    NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, fall) (native_handle, NULL);
+    return true;
+  }
+
+  // Assuming we actually have a callback now...
+  CHECK_ARGUMENT_TYPE_ALWAYS(InterruptIn, fall, 0, function);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jerry_object_t *fptr = jsmbed_wrap_unbox_object(&args_p[0]);
+  jsmbed_wrap_acquire_object(fptr);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, fall) (native_handle, fptr);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(InterruptIn, mode)
+{
+  CHECK_ARGUMENT_COUNT(InterruptIn, mode, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(InterruptIn, mode, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int pull = jsmbed_wrap_unbox_number(&args_p[0]);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, mode) (native_handle, pull);
+  return true;
+}
+
+// Unboxes a debounce argument, which must be a number no less than min
+// (checked as a double, so that NaN is rejected too). Large values are
+// clamped rather than overflowing the int.
+static bool jsmbed_unbox_debounce_arg(const jerry_value_t *val_p, const char *name, double min, int *value)
+{
+  double number = jsmbed_wrap_unbox_number(val_p);
+  if (!(number >= min))
+  {
+    printf("ERROR: InterruptIn.debounce %s must be at least %d.\n", name, (int) min);
+    return false;
+  }
+  *value = (number > INT_MAX) ? INT_MAX : (int) number;
+  return true;
+}
+
+// debounce(windowUs[, stableUs[, samples]]): edges within windowUs of the
+// last one passed on are ignored, the level has to hold for stableUs, and
+// is the majority of samples reads. debounce(0) turns it off.
+DECLARE_CLASS_FUNCTION(InterruptIn, debounce)
+{
+  CHECK_ARGUMENT_COUNT(InterruptIn, debounce, (args_count >= 1 && args_count <= 3));
+  CHECK_ARGUMENT_TYPE_ALWAYS(InterruptIn, debounce, 0, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(InterruptIn, debounce, 1, number, (args_count >= 2));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(InterruptIn, debounce, 2, number, (args_count == 3));
+
+  int window_us;
+  int stable_us = 0;
+  int samples = 1;
+  if (!jsmbed_unbox_debounce_arg(&args_p[0], "windowUs", 0, &window_us) ||
+      (args_count >= 2 && !jsmbed_unbox_debounce_arg(&args_p[1], "stableUs", 0, &stable_us)) ||
+      (args_count == 3 && !jsmbed_unbox_debounce_arg(&args_p[2], "samples", 1, &samples)))
+  {
+    return false;
+  }
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, debounce) (native_handle, window_us, stable_us, samples);
+  return true;
+}
+
+// countEdges('rise' | 'fall' | 'both' | null) counts edges natively, after
+// any debouncing, whether or not there are callbacks.
+DECLARE_CLASS_FUNCTION(InterruptIn, countEdges)
+{
+  CHECK_ARGUMENT_COUNT(InterruptIn, countEdges, (args_count == 1));
+  int edges = JSMBED_INTERRUPT_IN_COUNT_NONE;
+  if (!jsmbed_wrap_value_is_null(&args_p[0]))
+  {
+    CHECK_ARGUMENT_TYPE_ALWAYS(InterruptIn, countEdges, 0, string);
+    jerry_string_t *edges_string = jsmbed_wrap_unbox_string(&args_p[0]);
+    if (jsmbed_wrap_string_equals(edges_string, "rise"))
+    {
+      edges = JSMBED_INTERRUPT_IN_COUNT_RISE;
+    }
+    else if (jsmbed_wrap_string_equals(edges_string, "fall"))
+    {
+      edges = JSMBED_INTERRUPT_IN_COUNT_FALL;
+    }
+    else if (jsmbed_wrap_string_equals(edges_string, "both"))
+    {
+      edges = JSMBED_INTERRUPT_IN_COUNT_BOTH;
+    }
+    else
+    {
+      printf("ERROR: InterruptIn.countEdges takes 'rise', 'fall', 'both' or null.\n");
+      return false;
+    }
+  }
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, count_edges) (native_handle, edges);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(InterruptIn, count)
+{
+  CHECK_ARGUMENT_COUNT(InterruptIn, count, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_uint32(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, count) (native_handle));
+  return true;
+}
+
+// Returns the count from before the reset, so that no edges are lost
+// between reading and resetting.
+DECLARE_CLASS_FUNCTION(InterruptIn, resetCount)
+{
+  CHECK_ARGUMENT_COUNT(InterruptIn, resetCount, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_uint32(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, reset_count) (native_handle));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(InterruptIn, disable_irq)
+{
+  CHECK_ARGUMENT_COUNT(InterruptIn, disable_irq, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, disable_irq) (native_handle);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(InterruptIn, enable_irq)
+{
+  CHECK_ARGUMENT_COUNT(InterruptIn, enable_irq, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(InterruptIn, enable_irq) (native_handle);
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(InterruptIn)
+{
+  CHECK_ARGUMENT_COUNT(InterruptIn, __constructor, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(InterruptIn, __constructor, 0, number);
+  int pin = jsmbed_wrap_unbox_number(&args_p[0]);
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(InterruptIn, I) (pin);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(InterruptIn));
+  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, rise);
+  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, fall);
+  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, mode);
+  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, debounce);
+  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, countEdges);
+  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, count);
+  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, resetCount);
+  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, enable_irq);
+  ATTACH_CLASS_FUNCTION(js_object, InterruptIn, disable_irq);
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// PulseIn
+//
+// window(periods[, timeoutUs]) sets how many measurements are averaged,
+// and how long without an edge before the signal counts as stopped.
+DECLARE_CLASS_FUNCTION(PulseIn, window)
+{
+  CHECK_ARGUMENT_COUNT(PulseIn, window, (args_count == 1 || args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PulseIn, window, 0, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(PulseIn, window, 1, number, (args_count == 2));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int periods = jsmbed_wrap_unbox_number(&args_p[0]);
+  int timeout_us = (args_count == 2) ? (int) jsmbed_wrap_unbox_number(&args_p[1]) : 0;
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, window)(native_handle, periods, timeout_us);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(PulseIn, read)
+{
+  CHECK_ARGUMENT_COUNT(PulseIn, read, (args_count <= 1));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(PulseIn, read, 0, object, (args_count == 1));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+
+  jsmbed_pulse_in_stats_t native_stats;
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, read)(native_handle, &native_stats);
+
+  jerry_object_t *stats = jsmbed_wrap_result_object(args_p, args_count, 0);
+  jsmbed_wrap_fill_object(JS_SCHEMA(jsmbed_pulse_in_stats_t), &native_stats, stats);
+
+  jsmbed_wrap_box_object(ret_val_p, stats);
+  return true;
+}
+
+static jerry_object_t *jsmbed_pulse_in_box(const jsmbed_pulse_in_stats_t *stats)
+{
+  return jsmbed_wrap_struct_to_object(JS_SCHEMA(jsmbed_pulse_in_stats_t), stats);
+}
+
+// start(reportMs, callback) calls back from the event loop with what read()
+// would return, every reportMs, until stop().
+DECLARE_CLASS_FUNCTION(PulseIn, start)
+{
+  CHECK_ARGUMENT_COUNT(PulseIn, start, (args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PulseIn, start, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(PulseIn, start, 1, function);
+
+  int report_ms = jsmbed_wrap_unbox_number(&args_p[0]);
+  if (report_ms <= 0)
+  {
+    printf("ERROR: PulseIn.start report interval must be at least 1ms.\n");
+    return false;
+  }
+
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jerry_object_t *fptr = jsmbed_wrap_unbox_object(&args_p[1]);
+  jsmbed_wrap_acquire_object(fptr);
+  jerry_object_t *owner = jsmbed_wrap_unbox_object(this_p);
+  jsmbed_wrap_acquire_object(owner);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, start)(native_handle, owner, report_ms, jsmbed_pulse_in_box, fptr);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(PulseIn, stop)
+{
+  CHECK_ARGUMENT_COUNT(PulseIn, stop, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  NAME_FOR_CLASS_NATIVE_FUNCTION(PulseIn, stop)(native_handle);
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(PulseIn)
+{
+  CHECK_ARGUMENT_COUNT(PulseIn, __constructor, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(PulseIn, __constructor, 0, number);
+
+  int pin = jsmbed_wrap_unbox_number(&args_p[0]);
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(PulseIn, I) (pin);
+  if (native_handle == 0)
+  {
+    return false;
+  }
+
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_objects(js_object, native_handle, NAME_FOR_CLASS_NATIVE_DESTRUCTOR(PulseIn));
+  ATTACH_CLASS_FUNCTION(js_object, PulseIn, window);
+  ATTACH_CLASS_FUNCTION(js_object, PulseIn, read);
+  ATTACH_CLASS_FUNCTION(js_object, PulseIn, start);
+  ATTACH_CLASS_FUNCTION(js_object, PulseIn, stop);
+
+  jsmbed_wrap_box_object(ret_val_p, js_object);
+  return true;
+}
+
+//
+// TypedArray
+//
+// Negative indices count back from the end of the array, as they do for
+// the standard typed arrays.
+static int resolve_relative_index(const jerry_value_t *val_p, int length)
+{
+  int index = jsmbed_wrap_unbox_number(val_p);
+  if (index < 0)
+  {
+    index += length;
+  }
+  if (index < 0)
+  {
+    return 0;
+  }
+  return (index > length) ? length : index;
+}
+
+DECLARE_CLASS_FUNCTION(TypedArray, get)
+{
+  CHECK_ARGUMENT_COUNT(TypedArray, get, (args_count == 1));
+  CHECK_ARGUMENT_TYPE_ALWAYS(TypedArray, get, 0, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int index = jsmbed_wrap_unbox_number(&args_p[0]);
+  if (index < 0 || index >= NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, length)(native_handle))
+  {
+    jsmbed_wrap_box_undefined(ret_val_p);
+    return true;
+  }
+  double result = NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, get)(native_handle, index);
+  jsmbed_wrap_box_number(ret_val_p, result);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(TypedArray, set)
+{
+  CHECK_ARGUMENT_COUNT(TypedArray, set, (args_count == 2));
+  CHECK_ARGUMENT_TYPE_ALWAYS(TypedArray, set, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(TypedArray, set, 1, number);
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int index = jsmbed_wrap_unbox_number(&args_p[0]);
+  double value = jsmbed_wrap_unbox_number(&args_p[1]);
+  // Out of range writes are ignored, as they are for the standard typed arrays.
+  if (index >= 0 && index < NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, length)(native_handle))
+  {
+    NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, set)(native_handle, index, value);
+  }
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(TypedArray, fill)
+{
+  CHECK_ARGUMENT_COUNT(TypedArray, fill, (args_count >= 1 && args_count <= 3));
+  CHECK_ARGUMENT_TYPE_ALWAYS(TypedArray, fill, 0, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(TypedArray, fill, 1, number, (args_count >= 2));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(TypedArray, fill, 2, number, (args_count == 3));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int length = NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, length)(native_handle);
+  double value = jsmbed_wrap_unbox_number(&args_p[0]);
+  int begin = (args_count >= 2) ? resolve_relative_index(&args_p[1], length) : 0;
+  int end = (args_count == 3) ? resolve_relative_index(&args_p[2], length) : length;
+  NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, fill)(native_handle, value, begin, end);
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(TypedArray, copyWithin)
+{
+  CHECK_ARGUMENT_COUNT(TypedArray, copyWithin, (args_count == 2 || args_count == 3));
+  CHECK_ARGUMENT_TYPE_ALWAYS(TypedArray, copyWithin, 0, number);
+  CHECK_ARGUMENT_TYPE_ALWAYS(TypedArray, copyWithin, 1, number);
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(TypedArray, copyWithin, 2, number, (args_count == 3));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int length = NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, length)(native_handle);
+  int target = resolve_relative_index(&args_p[0], length);
+  int begin = resolve_relative_index(&args_p[1], length);
+  int end = (args_count == 3) ? resolve_relative_index(&args_p[2], length) : length;
+  NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, copyWithin)(native_handle, target, begin, end);
+  return true;
+}
+
+static jerry_object_t *jsmbed_create_js_typed_array(uintptr_t native_handle);
+
+DECLARE_CLASS_FUNCTION(TypedArray, subarray)
+{
+  CHECK_ARGUMENT_COUNT(TypedArray, subarray, (args_count <= 2));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(TypedArray, subarray, 0, number, (args_count >= 1));
+  CHECK_ARGUMENT_TYPE_ON_CONDITION(TypedArray, subarray, 1, number, (args_count == 2));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  int length = NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, length)(native_handle);
+  int begin = (args_count >= 1) ? resolve_relative_index(&args_p[0], length) : 0;
+  int end = (args_count == 2) ? resolve_relative_index(&args_p[1], length) : length;
+  uintptr_t sub_handle = NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, subarray)(native_handle, begin, end);
+  jsmbed_wrap_box_object(ret_val_p, jsmbed_create_js_typed_array(sub_handle));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(TypedArray, sum)
+{
+  CHECK_ARGUMENT_COUNT(TypedArray, sum, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_number(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, sum)(native_handle));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(TypedArray, min)
+{
+  CHECK_ARGUMENT_COUNT(TypedArray, min, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_number(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, min)(native_handle));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(TypedArray, max)
+{
+  CHECK_ARGUMENT_COUNT(TypedArray, max, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_number(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, max)(native_handle));
+  return true;
+}
+
+DECLARE_CLASS_FUNCTION(TypedArray, mean)
+{
+  CHECK_ARGUMENT_COUNT(TypedArray, mean, (args_count == 0));
+  uintptr_t native_handle = jsmbed_wrap_get_native_handle(this_p);
+  jsmbed_wrap_box_number(ret_val_p, NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, mean)(native_handle));
+  return true;
+}
+
+static jerry_object_t *jsmbed_create_js_typed_array(uintptr_t native_handle)
+{
+  jerry_object_t *js_object = jsmbed_wrap_create_object();
+  jsmbed_wrap_link_typed_array(js_object, (JSTypedArray*) native_handle);
+
+  jsmbed_set_uint32_field(js_object, JS_KEY(length), NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, length)(native_handle));
+
+  ATTACH_CLASS_FUNCTION(js_object, TypedArray, get);
+  ATTACH_CLASS_FUNCTION(js_object, TypedArray, set);
+  ATTACH_CLASS_FUNCTION(js_object, TypedArray, fill);
+  ATTACH_CLASS_FUNCTION(js_object, TypedArray, copyWithin);
+  ATTACH_CLASS_FUNCTION(js_object, TypedArray, subarray);
+  ATTACH_CLASS_FUNCTION(js_object, TypedArray, sum);
+  ATTACH_CLASS_FUNCTION(js_object, TypedArray, min);
+  ATTACH_CLASS_FUNCTION(js_object, TypedArray, max);
+  ATTACH_CLASS_FUNCTION(js_object, TypedArray, mean);
+  return js_object;
+}
+
+/*
+ * Shared by all of the typed array constructors. Either takes a length, in
+ * which case the array is zero filled, or a JS array to copy values from.
+ */
+static bool jsmbed_construct_typed_array(TypedArrayType type,
+                                         jerry_value_t *ret_val_p,
+                                         const jerry_value_t args_p[],
+                                         const jerry_length_t args_count)
+{
+  CHECK_ARGUMENT_COUNT(TypedArray, __constructor, (args_count == 1));
+
+  if (jsmbed_wrap_value_is_number(&args_p[0]))
+  {
+    double requested = jsmbed_wrap_unbox_number(&args_p[0]);
+    // Also rejects NaN, and checked as a double so it can't wrap first.
+    if (!(requested >= 0 && requested <= JSTypedArray::max_length(type)))
+    {
+      printf("ERROR: Typed array length must be between 0 and %u.\n", JSTypedArray::max_length(type));
+      return false;
+    }
+    int length = (int) requested;
+    uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(TypedArray, I_I) (type, length);
+    jsmbed_wrap_box_object(ret_val_p, jsmbed_create_js_typed_array(native_handle));
+    return true;
+  }
+
+  CHECK_ARGUMENT_TYPE_ALWAYS(TypedArray, __constructor, 0, object);
+  int length = jsmbed_wrap_get_array_length(&args_p[0]);
+  if (length < 0 || (uint32_t) length > JSTypedArray::max_length(type))
+  {
+    printf("ERROR: Typed array length must be between 0 and %u.\n", JSTypedArray::max_length(type));
+    return false;
+  }
+  uintptr_t native_handle = NAME_FOR_CLASS_NATIVE_CONSTRUCTOR(TypedArray, I_I) (type, length);
+
+  jerry_value_t element_value;
+  jerry_object_t *array_object = jsmbed_wrap_unbox_object(&args_p[0]);
+  for (int index = 0; index < length; index++)
+  {
+    jerry_get_array_index_value(array_object, index, &element_value);
+    if (jsmbed_wrap_value_is_number(&element_value))
+    {
+      NAME_FOR_CLASS_NATIVE_FUNCTION(TypedArray, set)
+          (native_handle, index, jsmbed_wrap_unbox_number(&element_value));
+    }
+    jerry_release_value(&element_value);
+  }
+
+  jsmbed_wrap_box_object(ret_val_p, jsmbed_create_js_typed_array(native_handle));
+  return true;
+}
+
+DECLARE_CLASS_CONSTRUCTOR(Uint8Array)
+{
+  return jsmbed_construct_typed_array(TYPED_ARRAY_UINT8, ret_val_p, args_p, args_count);
+}
+
+DECLARE_CLASS_CONSTRUCTOR(Int16Array)
+{
+  return jsmbed_construct_typed_array(TYPED_ARRAY_INT16, ret_val_p, args_p, args_count);
+}
+
+DECLARE_CLASS_CONSTRUCTOR(Uint16Array)
+{
+  return jsmbed_construct_typed_array(TYPED_ARRAY_UINT16, ret_val_p, args_p, args_count);
+}
+
+DECLARE_CLASS_CONSTRUCTOR(Int32Array)
+{
+  return jsmbed_construct_typed_array(TYPED_ARRAY_INT32, ret_val_p, args_p, args_count);
+}
+
+DECLARE_CLASS_CONSTRUCTOR(Float32Array)
+{
+  return jsmbed_construct_typed_array(TYPED_ARRAY_FLOAT32, ret_val_p, args_p, args_count);
+}
+
+DECLARE_JS_WRAPPER_REGISTRATION (base)
+{
+  INTERN_JS_SCHEMA (pool_stats_t);
+  INTERN_JS_SCHEMA (jsmbed_wrap_profile_entry_t);
+  INTERN_JS_SCHEMA (jsmbed_wrap_external_memory_stats_t);
+  INTERN_JS_SCHEMA (jsmbed_wrap_scratch_stats_t);
+  INTERN_JS_SCHEMA (jsmbed_framer_stats_t);
+  INTERN_JS_SCHEMA (jsmbed_pulse_in_stats_t);
+#ifdef JMEM_STATS
+  INTERN_JS_SCHEMA (heap_stats_t);
+#endif
 
-DECLARE_JS_WRAPPER_REGISTRATION (base)
-{
   REGISTER_GLOBAL_FUNCTION (assert);
   REGISTER_GLOBAL_FUNCTION (gc);
+  REGISTER_GLOBAL_FUNCTION (pool_stats);
+  REGISTER_GLOBAL_FUNCTION (binding_stats);
+  REGISTER_GLOBAL_FUNCTION (print_binding_stats);
+  REGISTER_GLOBAL_FUNCTION (reset_binding_stats);
+  REGISTER_GLOBAL_FUNCTION (external_memory);
+  REGISTER_GLOBAL_FUNCTION (set_external_memory_threshold);
+  REGISTER_GLOBAL_FUNCTION (scratch_stats);
+#ifdef JMEM_STATS
+  REGISTER_GLOBAL_FUNCTION (heap_stats);
+#endif
   REGISTER_CLASS_CONSTRUCTOR (DigitalOut);
+  REGISTER_CLASS_CONSTRUCTOR (BusOut);
+  REGISTER_CLASS_CONSTRUCTOR (PortOut);
+  REGISTER_CLASS_CONSTRUCTOR (DigitalOutGroup);
+  REGISTER_CLASS_CONSTRUCTOR (DigitalIn);
+  REGISTER_CLASS_CONSTRUCTOR (BusIn);
+  REGISTER_CLASS_CONSTRUCTOR (PortIn);
   REGISTER_CLASS_CONSTRUCTOR (I2C);
+  REGISTER_CLASS_CONSTRUCTOR (SPI);
+  REGISTER_CLASS_CONSTRUCTOR (Serial);
+  REGISTER_CLASS_CONSTRUCTOR (Framer);
+  REGISTER_CLASS_CONSTRUCTOR (AnalogIn);
+  REGISTER_CLASS_CONSTRUCTOR (AnalogSampler);
+  REGISTER_CLASS_CONSTRUCTOR (PwmOut);
   REGISTER_CLASS_CONSTRUCTOR (Ticker);
   REGISTER_CLASS_CONSTRUCTOR (InterruptIn);
+  REGISTER_CLASS_CONSTRUCTOR (PulseIn);
+  REGISTER_CLASS_CONSTRUCTOR (Uint8Array);
+  REGISTER_CLASS_CONSTRUCTOR (Int16Array);
+  REGISTER_CLASS_CONSTRUCTOR (Uint16Array);
+  REGISTER_CLASS_CONSTRUCTOR (Int32Array);
+  REGISTER_CLASS_CONSTRUCTOR (Float32Array);
 }
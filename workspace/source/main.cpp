@@ -16,19 +16,10 @@
 // Provides jsmbed_js_launch()
 #include "jsmbed_js_launcher.h"
 
-// Provides JSMBED_USE_WRAPPER()
-#include "jsmbed_wrap_registry.h"
-
-// Provides the base wrapper registration symbol that JSMBED_USE_WRAPPER uses.
-// This means all of the base handlers will be registered.
-#include "pkgjsmbed_base_wrapper.h"
-
 int main() {
-  JSMBED_USE_WRAPPER(base);
-  // Incude more wrapper packages here if you want to use them. For exmaple:
-  //JSMBED_USE_WRAPPER(lwip_interface);
-  //JSMBED_USE_WRAPPER(esp8266_interface);
-  //JSMBED_USE_WRAPPER(simple_mbed_client);
+  // The wrapper packages that are registered are listed by
+  // JSMBED_WRAP_PACKAGES (see jsmbed_wrap_registry.h), which includes just the
+  // base package by default.
   jsmbed_js_launch();
   return 0;
-}
\ No newline at end of file
+}